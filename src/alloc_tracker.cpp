@@ -0,0 +1,25 @@
+// Contadores de alocações no heap (veja "arena.hpp"). As substituições do
+// operator new/delete ficam em um arquivo próprio para que o compilador não
+// as enxergue, inlined, junto das chamadas da biblioteca padrão.
+#include <cstdlib>
+#include <new>
+
+#include "arena.hpp"
+
+std::atomic<size_t> g_HeapAllocations(0);
+std::atomic<size_t> g_HeapAllocatedBytes(0);
+
+// Substituições do operator new/delete globais. As versões nothrow e de
+// vetores da biblioteca padrão chamam estas.
+void* operator new(size_t size) {
+  g_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+  g_HeapAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+  void* p = malloc(size > 0 ? size : 1);
+  if (p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
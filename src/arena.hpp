@@ -0,0 +1,127 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Alocações feitas no heap pelo operator new global desde o início do
+// programa, contadas pela substituição do operator new em "alloc_tracker.cpp"
+extern std::atomic<size_t> g_HeapAllocations;
+extern std::atomic<size_t> g_HeapAllocatedBytes;
+
+// Memória temporária de um quadro. As alocações só avançam um ponteiro dentro
+// de um bloco fixo e nada é liberado individualmente: reset(), no começo de
+// cada quadro, descarta tudo de uma vez. Quando o bloco acaba, a alocação vai
+// para o heap (e aparece nos contadores acima), então um bloco pequeno demais
+// não quebra nada, só deixa de evitar as alocações.
+class FrameArena {
+  public:
+  explicit FrameArena(size_t capacity)
+      : block(static_cast<unsigned char*>(::operator new(capacity))), capacity(capacity) {
+  }
+
+  ~FrameArena() {
+    ::operator delete(block);
+  }
+
+  void* allocate(size_t bytes, size_t alignment) {
+    size_t begin = (used + alignment - 1) & ~(alignment - 1);
+    if (begin + bytes > capacity) {
+      overflows++;
+      return ::operator new(bytes);
+    }
+    used = begin + bytes;
+    peak = (used > peak) ? used : peak;
+    return block + begin;
+  }
+
+  // Só a memória que veio do heap precisa ser devolvida
+  void deallocate(void* p) {
+    if (!owns(p))
+      ::operator delete(p);
+  }
+
+  bool owns(const void* p) const {
+    return p >= block && p < block + capacity;
+  }
+
+  void reset() {
+    used = 0;
+  }
+
+  size_t getUsed() const {
+    return used;
+  }
+
+  // Maior uso de um quadro e alocações que não couberam no bloco
+  size_t getPeak() const {
+    return peak;
+  }
+
+  size_t getOverflows() const {
+    return overflows;
+  }
+
+  private:
+  FrameArena(const FrameArena&);
+  FrameArena& operator=(const FrameArena&);
+
+  unsigned char* block;
+  size_t         capacity;
+  size_t         used      = 0;
+  size_t         peak      = 0;
+  size_t         overflows = 0;
+};
+
+// Alocador para os contêineres da biblioteca padrão que usa uma FrameArena.
+// Os contêineres precisam ser destruídos (ou esvaziados com shrink_to_fit)
+// antes do reset() da arena.
+template <typename T>
+class ArenaAllocator {
+  public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(FrameArena& arena)
+      : arena(&arena) {
+  }
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other)
+      : arena(other.getArena()) {
+  }
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, size_t) {
+    arena->deallocate(p);
+  }
+
+  FrameArena* getArena() const {
+    return arena;
+  }
+
+  private:
+  FrameArena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.getArena() != b.getArena();
+}
+
+// Vetor temporário de um quadro
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // ARENA_HPP
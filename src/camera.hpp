@@ -12,17 +12,15 @@
 class Camera {
   public:
   bool              UsePerspectiveProjection;
-  virtual glm::mat4 getMatrixView()                     = 0;
-  virtual glm::mat4 getMatrixProjection()               = 0;
   virtual float     getTheta()                          = 0;
   virtual void      setTheta(float theta)               = 0;
   virtual float     getPhi()                            = 0;
   virtual void      setPhi(float phi)                   = 0;
   virtual glm::vec4 getPosition()                       = 0;
   virtual void      setPosition(glm::vec4 position)     = 0;
-  virtual void      setUsePerspectiveProjection(bool b) = 0;
   virtual float     getScreenRatio()                    = 0;
   virtual void      setScreenRatio(float screenRatio)   = 0;
+  virtual void      setFarPlane(float farPlane)         = 0;
   virtual void      setDistance(float Distance)         = 0;
   virtual float     getDistance()                       = 0;
   virtual void      MoveForward(float deltaTime)        = 0;
@@ -35,9 +33,104 @@ class Camera {
   virtual glm::vec4 getViewVector()                     = 0;
   virtual glm::vec4 getUpVector()                       = 0;
 
+  // As matrizes view, projection, o produto projection*view e os seis planos
+  // do frustum ficam em cache. Elas só são recalculadas quando algum setter
+  // marca a câmera como "suja" (veja markViewDirty() e markProjectionDirty()).
+  const glm::mat4& getMatrixView() {
+    updateCachedMatrices();
+    return CachedView;
+  }
+
+  const glm::mat4& getMatrixProjection() {
+    updateCachedMatrices();
+    return CachedProjection;
+  }
+
+  const glm::mat4& getMatrixViewProjection() {
+    updateCachedMatrices();
+    return CachedViewProjection;
+  }
+
+  // Planos na ordem: esquerda, direita, baixo, cima, near, far. As normais
+  // apontam para dentro do frustum e estão normalizadas, de forma que
+  // dot(normal, p) - distance é a distância com sinal do ponto p ao plano.
+  const collision::Plane* getFrustumPlanes() {
+    updateCachedMatrices();
+    return FrustumPlanes;
+  }
+
+  void setUsePerspectiveProjection(bool b) {
+    UsePerspectiveProjection = b;
+    markProjectionDirty();
+  }
+
+  protected:
+  virtual glm::mat4 computeMatrixView()       = 0;
+  virtual glm::mat4 computeMatrixProjection() = 0;
+
+  // A projeção ortográfica depende da distância da câmera, então qualquer
+  // mudança de posição também invalida a projeção nesse modo.
+  void markViewDirty() {
+    ViewDirty = true;
+    if (!UsePerspectiveProjection)
+      ProjectionDirty = true;
+  }
+
+  void markProjectionDirty() {
+    ProjectionDirty = true;
+  }
 
   private:
   float Radius;
+
+  bool             ViewDirty       = true;
+  bool             ProjectionDirty = true;
+  glm::mat4        CachedView;
+  glm::mat4        CachedProjection;
+  glm::mat4        CachedViewProjection;
+  collision::Plane FrustumPlanes[6];
+
+  void updateCachedMatrices() {
+    if (!ViewDirty && !ProjectionDirty)
+      return;
+
+    if (ViewDirty)
+      CachedView = computeMatrixView();
+    if (ProjectionDirty)
+      CachedProjection = computeMatrixProjection();
+
+    CachedViewProjection = CachedProjection * CachedView;
+    extractFrustumPlanes();
+
+    ViewDirty       = false;
+    ProjectionDirty = false;
+  }
+
+  // Extração dos planos diretamente da matriz projection*view (método de
+  // Gribb e Hartmann). Um ponto p está dentro do frustum se
+  // -w <= x,y,z <= w, onde (x,y,z,w) = M*p; cada desigualdade é um plano.
+  void extractFrustumPlanes() {
+    const glm::mat4& M = CachedViewProjection;
+    glm::vec4        row[4];
+    for (int i = 0; i < 4; i++)
+      row[i] = glm::vec4(M[0][i], M[1][i], M[2][i], M[3][i]);
+
+    const glm::vec4 planes[6] = {
+        row[3] + row[0], // Esquerda
+        row[3] - row[0], // Direita
+        row[3] + row[1], // Baixo
+        row[3] - row[1], // Cima
+        row[3] + row[2], // Near
+        row[3] - row[2]  // Far
+    };
+
+    for (int i = 0; i < 6; i++) {
+      glm::vec3 normal          = glm::vec3(planes[i]);
+      float     length          = glm::length(normal);
+      FrustumPlanes[i].normal   = normal / length;
+      FrustumPlanes[i].distance = -planes[i].w / length;
+    }
+  }
 };
 
 class SphericCamera : public Camera {
@@ -68,11 +161,27 @@ class SphericCamera : public Camera {
 
   void updateViewVector() {
     ViewVector = LookAt - Position;
+    markViewDirty();
   }
 
-  public:
-  bool UsePerspectiveProjection;
+  protected:
+  glm::mat4 computeMatrixView() {
+    return Matrix_Camera_View(Position, ViewVector, UpVector);
+  }
 
+  glm::mat4 computeMatrixProjection() {
+    if (UsePerspectiveProjection)
+      return Matrix_Perspective(FieldOfView, ScreenRatio, NearPlane, FarPlane);
+    else {
+      float t = 1.5f * Distance / 2.5f;
+      float b = -t;
+      float r = t * ScreenRatio;
+      float l = -r;
+      return Matrix_Orthographic(l, r, b, t, NearPlane, FarPlane);
+    }
+  }
+
+  public:
   SphericCamera(float     speed,
                 float     theta,
                 float     phi,
@@ -108,22 +217,6 @@ class SphericCamera : public Camera {
     return Position;
   }
 
-  glm::mat4 getMatrixView() {
-    return Matrix_Camera_View(Position, ViewVector, UpVector);
-  }
-
-  glm::mat4 getMatrixProjection() {
-    if (UsePerspectiveProjection)
-      return Matrix_Perspective(FieldOfView, ScreenRatio, NearPlane, FarPlane);
-    else {
-      float t = 1.5f * Distance / 2.5f;
-      float b = -t;
-      float r = t * ScreenRatio;
-      float l = -r;
-      return Matrix_Orthographic(l, r, b, t, NearPlane, FarPlane);
-    }
-  }
-
   float getTheta() {
     return Theta;
   }
@@ -174,16 +267,21 @@ class SphericCamera : public Camera {
     updatePosition();
   }
 
-  void setUsePerspectiveProjection(bool b) {
-    UsePerspectiveProjection = b;
-  }
-
   float getScreenRatio() {
     return ScreenRatio;
   }
 
   void setScreenRatio(float screenRatio) {
     ScreenRatio = screenRatio;
+    markProjectionDirty();
+  }
+
+  void setFarPlane(float farPlane) {
+    // Evita invalidar o cache quando o valor não muda
+    if (FarPlane == farPlane)
+      return;
+    FarPlane = farPlane;
+    markProjectionDirty();
   }
 
   void MoveForward(float deltaTime) {
@@ -263,6 +361,7 @@ class FreeCamera : public Camera {
     ViewVector.w = 0.0f;
     ViewVector   = glm::normalize(ViewVector);
     updateUVW();
+    markViewDirty();
   }
 
   void updateUVW() {
@@ -271,9 +370,24 @@ class FreeCamera : public Camera {
     v = crossproduct(w, u);
   }
 
-  public:
-  bool UsePerspectiveProjection;
+  protected:
+  glm::mat4 computeMatrixView() {
+    return Matrix_Camera_View(Position, ViewVector, UpVector);
+  }
+
+  glm::mat4 computeMatrixProjection() {
+    if (UsePerspectiveProjection)
+      return Matrix_Perspective(FieldOfView, ScreenRatio, NearPlane, FarPlane);
+    else {
+      float t = 1.5f * glm::length(Position) / 2.5f;
+      float b = -t;
+      float r = t * ScreenRatio;
+      float l = -r;
+      return Matrix_Orthographic(l, r, b, t, NearPlane, FarPlane);
+    }
+  }
 
+  public:
   FreeCamera(float     speed,
              float     theta,
              float     phi,
@@ -303,50 +417,41 @@ class FreeCamera : public Camera {
     return Position;
   }
 
-  glm::mat4 getMatrixView() {
-    return Matrix_Camera_View(Position, ViewVector, UpVector);
-  }
-
-  glm::mat4 getMatrixProjection() {
-    if (UsePerspectiveProjection)
-      return Matrix_Perspective(FieldOfView, ScreenRatio, NearPlane, FarPlane);
-    else {
-      float t = 1.5f * glm::length(Position) / 2.5f;
-      float b = -t;
-      float r = t * ScreenRatio;
-      float l = -r;
-      return Matrix_Orthographic(l, r, b, t, NearPlane, FarPlane);
-    }
-  }
-
   void MoveForward(float deltaTime) {
     glm::vec4 forward = glm::normalize(glm::vec4(ViewVector.x, 0.0, ViewVector.z, 0.0));
     Position += forward * Speed * deltaTime;
+    markViewDirty();
   }
 
   void MoveBackward(float deltaTime) {
     glm::vec4 forward = glm::normalize(glm::vec4(ViewVector.x, 0.0, ViewVector.z, 0.0));
     Position -= forward * Speed * deltaTime;
+    markViewDirty();
   }
 
   void MoveLeft(float deltaTime) {
     Position -= u * Speed * deltaTime;
+    markViewDirty();
   }
 
   void MoveRight(float deltaTime) {
     Position += glm::normalize(crossproduct(ViewVector, UpVector)) * Speed * deltaTime;
+    markViewDirty();
   }
 
   void MoveUpwards(float deltaTime) {
     Position -= glm::normalize(crossproduct(ViewVector, UpVector)) * Speed * deltaTime;
+    markViewDirty();
   }
 
   void MoveDownwards(float deltaTime) {
     Position -= UpVector * Speed * deltaTime;
+    markViewDirty();
   }
 
   void setPosition(glm::vec4 position) {
     Position = position;
+    markViewDirty();
   }
 
 
@@ -400,10 +505,15 @@ class FreeCamera : public Camera {
 
   void setScreenRatio(float screenRatio) {
     ScreenRatio = screenRatio;
+    markProjectionDirty();
   }
 
-  void setUsePerspectiveProjection(bool b) {
-    UsePerspectiveProjection = b;
+  void setFarPlane(float farPlane) {
+    // Evita invalidar o cache quando o valor não muda
+    if (FarPlane == farPlane)
+      return;
+    FarPlane = farPlane;
+    markProjectionDirty();
   }
 
   void setLookAt(glm::vec4 lookAt) {
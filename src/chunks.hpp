@@ -0,0 +1,409 @@
+#ifndef CHUNKS_HPP
+#define CHUNKS_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+#include "collisions.hpp"
+#include "maze.hpp"
+#include "mesh.hpp"
+
+// Mundo "infinito" formado por pedaços (chunks) de labirinto de
+// kChunkCells x kChunkCells células. Cada chunk é gerado de forma
+// determinística a partir de (semente, coordenadas do chunk), então pode ser
+// descartado e gerado de novo a qualquer momento com o mesmo resultado.
+//
+// O chunk (0, 0) é ocupado pelo labirinto inicial criado em main() e nunca é
+// gerado aqui. A célula (x, y) do chunk (cx, cy) é a célula global
+// (cx * kChunkCells + x, cy * kChunkCells + y), com as mesmas coordenadas do
+// mundo de MazeGenerator::cellToWorldCoords().
+const int   kChunkCells       = 20;
+const float kChunkCellSize    = 2.0f;
+const float kChunkWallHeight  = 3.0f;
+const float kChunkWallThick   = 0.2f;
+const float kChunkWallBottomY = -1.1f; // Mesma translação das paredes do labirinto inicial
+
+// Chunks enviados à GPU por update(), no máximo. O restante fica para os
+// próximos quadros, para que a chegada de vários chunks não cause picos.
+// Quem controla o tempo do quadro por outros meios passa 0 a update() e
+// chama uploadNext().
+const int kMaxChunkUploadsPerFrame = 2;
+
+// Um chunk pronto: geometria das paredes (unidas em caixas longas, já em
+// coordenadas globais) e as caixas usadas na colisão.
+struct MazeChunk {
+  int cx, cy;
+
+  vector<PackedVertex>    vertices; // Liberados após o envio para a GPU
+  vector<uint32_t>        indices;
+  vector<collision::AABB> walls;
+  collision::AABB         bounds;
+  size_t                  index_count;
+
+  // Preenchidos pela função de envio para a GPU
+  unsigned int vertex_array_object_id = 0;
+  unsigned int vertex_buffer_id       = 0;
+  unsigned int index_buffer_id        = 0;
+  size_t       gpu_bytes              = 0;
+};
+
+// Mistura (semente, chunk, "sal") em 64 bits bem distribuídos (SplitMix64)
+uint64_t ChunkHash(uint64_t seed, int cx, int cy, uint64_t salt) {
+  uint64_t z = seed ^ (uint64_t(uint32_t(cx)) << 32 | uint32_t(cy)) * 0x9E3779B97F4A7C15ull ^ salt * 0xD1B54A32D192ED69ull;
+  z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z          = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// Chunk que contém o ponto (x, z) do mundo
+void WorldToChunk(float x, float z, int& cx, int& cy) {
+  const float chunkSize = kChunkCells * kChunkCellSize;
+  cx                    = static_cast<int>(floor((x + kChunkCellSize / 2.0f) / chunkSize));
+  cy                    = static_cast<int>(floor((z + kChunkCellSize / 2.0f) / chunkSize));
+}
+
+// Acrescenta a caixa [lo, hi] ao chunk, sem a face de baixo (nunca vista).
+// As coordenadas de textura repetem a textura a cada célula no comprimento
+// da parede, como nas paredes individuais do labirinto inicial.
+void AddChunkWallBox(MazeChunk& chunk, const glm::vec3& lo, const glm::vec3& hi) {
+  const glm::vec3 corners[8] = {
+      {lo.x, lo.y, lo.z}, {hi.x, lo.y, lo.z}, {hi.x, hi.y, lo.z}, {lo.x, hi.y, lo.z},
+      {lo.x, lo.y, hi.z}, {hi.x, lo.y, hi.z}, {hi.x, hi.y, hi.z}, {lo.x, hi.y, hi.z}};
+
+  // Mesma ordem (anti-horária) das faces de exportToObjModels()
+  const int       faces[5][4] = {{0, 3, 2, 1}, {4, 5, 6, 7}, {0, 4, 7, 3}, {2, 6, 5, 1}, {7, 6, 2, 3}};
+  const glm::vec3 normals[5]  = {{0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+
+  for (int f = 0; f < 5; f++) {
+    uint32_t base = static_cast<uint32_t>(chunk.vertices.size());
+    for (int k = 0; k < 4; k++) {
+      const glm::vec3& p = corners[faces[f][k]];
+
+      // Eixo horizontal da face e eixo vertical (altura, ou z no topo)
+      float u = (normals[f].x != 0.0f) ? (p.z - lo.z) / kChunkCellSize : (p.x - lo.x) / kChunkCellSize;
+      float v = (normals[f].y != 0.0f) ? (p.z - lo.z) / kChunkCellSize : (p.y - lo.y) / kChunkWallHeight;
+
+      PackedVertex vertex = {{p.x, p.y, p.z}, {normals[f].x, normals[f].y, normals[f].z}, {u, v}};
+      chunk.vertices.push_back(vertex);
+    }
+
+    const uint32_t quad[6] = {0, 1, 2, 0, 2, 3};
+    for (uint32_t i : quad)
+      chunk.indices.push_back(base + i);
+  }
+
+  chunk.walls.push_back(collision::AABB{lo, hi});
+}
+
+// Gera o chunk (chunk.cx, chunk.cy). Chamada pelas threads do streamer.
+//
+// O interior é um labirinto perfeito gerado com o algoritmo de Eller
+// (MazeGenerator::generateRows()). Cada chunk é dono apenas das suas bordas
+// norte e oeste, onde abre uma porta sorteada; as bordas sul e leste são
+// desenhadas pelos vizinhos. Assim as duas faces de uma borda nunca são
+// geradas duas vezes, e os vizinhos não precisam concordar sobre nada. As
+// bordas voltadas para o labirinto inicial ficam abertas: as paredes e
+// entradas dele já fazem esse papel.
+//
+// Paredes vizinhas alinhadas são unidas em uma única caixa, o que reduz os
+// vértices e as caixas testadas na colisão.
+void BuildMazeChunk(unsigned int seed, MazeChunk& chunk) {
+  const int K = kChunkCells;
+
+  vector<unsigned char> cells(K * K);
+  MazeGenerator::generateRows(K, K, static_cast<unsigned int>(ChunkHash(seed, chunk.cx, chunk.cy, 0)),
+                              [&](int y, const vector<unsigned char>& row) {
+                                copy(row.begin(), row.end(), cells.begin() + y * K);
+                              });
+
+  const bool northIsHome = (chunk.cx == 0 && chunk.cy == 1);
+  const bool westIsHome  = (chunk.cx == 1 && chunk.cy == 0);
+  const int  northDoor   = static_cast<int>(ChunkHash(seed, chunk.cx, chunk.cy, 1) % K);
+  const int  westDoor    = static_cast<int>(ChunkHash(seed, chunk.cx, chunk.cy, 2) % K);
+
+  // Canto (-1, -1) da célula (0, 0) do chunk, em coordenadas globais
+  const float originX = chunk.cx * K * kChunkCellSize - kChunkCellSize / 2.0f;
+  const float originZ = chunk.cy * K * kChunkCellSize - kChunkCellSize / 2.0f;
+  const float halfT   = kChunkWallThick / 2.0f;
+  const float bottom  = kChunkWallBottomY;
+  const float top     = kChunkWallBottomY + kChunkWallHeight;
+
+  chunk.vertices.clear();
+  chunk.indices.clear();
+  chunk.walls.clear();
+
+  // Paredes norte de cada linha, unidas em trechos contínuos
+  for (int y = 0; y < K; y++) {
+    float z = originZ + y * kChunkCellSize;
+    for (int x = 0; x < K;) {
+      bool present = (y == 0) ? (!northIsHome && x != northDoor) : (cells[y * K + x] & 1);
+      if (!present) {
+        x++;
+        continue;
+      }
+
+      int end = x + 1;
+      while (end < K && ((y == 0) ? (!northIsHome && end != northDoor) : (cells[y * K + end] & 1)))
+        end++;
+
+      AddChunkWallBox(chunk, glm::vec3(originX + x * kChunkCellSize, bottom, z - halfT),
+                      glm::vec3(originX + end * kChunkCellSize, top, z + halfT));
+      x = end;
+    }
+  }
+
+  // Paredes oeste de cada coluna
+  for (int x = 0; x < K; x++) {
+    float wx = originX + x * kChunkCellSize;
+    for (int y = 0; y < K;) {
+      bool present = (x == 0) ? (!westIsHome && y != westDoor) : ((cells[y * K + x] >> 3) & 1);
+      if (!present) {
+        y++;
+        continue;
+      }
+
+      int end = y + 1;
+      while (end < K && ((x == 0) ? (!westIsHome && end != westDoor) : ((cells[end * K + x] >> 3) & 1)))
+        end++;
+
+      AddChunkWallBox(chunk, glm::vec3(wx - halfT, bottom, originZ + y * kChunkCellSize),
+                      glm::vec3(wx + halfT, top, originZ + end * kChunkCellSize));
+      y = end;
+    }
+  }
+
+  chunk.index_count = chunk.indices.size();
+  chunk.bounds.min  = glm::vec3(originX - halfT, bottom, originZ - halfT);
+  chunk.bounds.max  = glm::vec3(originX + K * kChunkCellSize + halfT, top, originZ + K * kChunkCellSize + halfT);
+}
+
+// Mantém carregados os chunks a até "radius" chunks (na horizontal e na
+// vertical) do jogador. Chunks que faltam são gerados por threads em segundo
+// plano, do mais próximo para o mais distante; o envio para a GPU é feito na
+// thread principal (que tem o contexto OpenGL) pelas funções "upload" e
+// "release" passadas ao construtor.
+//
+// Os chunks residentes formam uma lista LRU limitada a "budget" chunks. Os
+// que saem do raio continuam na GPU até serem os menos usados e o orçamento
+// estourar, o que evita gerar de novo um chunk quando o jogador volta atrás.
+// Como o número de chunks residentes, pedidos e prontos é limitado, o custo
+// por quadro e a memória não crescem com a distância percorrida.
+class MazeChunkStreamer {
+  public:
+  using ChunkCallback = function<void(MazeChunk&)>;
+
+  MazeChunkStreamer(unsigned int seed, int radius, size_t budget, ChunkCallback upload, ChunkCallback release,
+                    unsigned int numThreads = max(1u, thread::hardware_concurrency() / 2))
+      : seed(seed), radius(radius), upload(upload), release(release) {
+    // O orçamento precisa comportar todos os chunks dentro do raio
+    const size_t window = static_cast<size_t>((2 * radius + 1) * (2 * radius + 1));
+    this->budget        = max(budget, window);
+
+    // Deslocamentos dentro do raio, do mais próximo para o mais distante
+    for (int dy = -radius; dy <= radius; dy++)
+      for (int dx = -radius; dx <= radius; dx++)
+        offsets.push_back({dx, dy});
+    sort(offsets.begin(), offsets.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+      return a.first * a.first + a.second * a.second < b.first * b.first + b.second * b.second;
+    });
+
+    for (unsigned int i = 0; i < numThreads; i++)
+      workers.emplace_back(&MazeChunkStreamer::workerLoop, this);
+  }
+
+  ~MazeChunkStreamer() {
+    {
+      lock_guard<mutex> lock(queueMutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (thread& worker : workers)
+      worker.join();
+
+    for (MazeChunk& chunk : resident)
+      release(chunk);
+  }
+
+  // Chamada uma vez por quadro, na thread principal, com a posição do
+  // jogador. Envia para a GPU até maxUploads chunks prontos.
+  void update(const glm::vec3& position, int maxUploads = kMaxChunkUploadsPerFrame) {
+    WorldToChunk(position.x, position.z, centerX, centerY);
+
+    bool newRequests = false;
+    {
+      lock_guard<mutex> lock(queueMutex);
+
+      // Pedidos que ainda não começaram e saíram do raio são cancelados
+      for (auto it = requests.begin(); it != requests.end();) {
+        if (inRadius(it->first, it->second)) {
+          ++it;
+          continue;
+        }
+        requested.erase(key(it->first, it->second));
+        it = requests.erase(it);
+      }
+
+      for (const pair<int, int>& offset : offsets) {
+        int cx = centerX + offset.first;
+        int cy = centerY + offset.second;
+        if (cx == 0 && cy == 0)
+          continue;
+
+        int64_t k  = key(cx, cy);
+        auto    it = residentIndex.find(k);
+        if (it != residentIndex.end()) {
+          resident.splice(resident.begin(), resident, it->second);
+        } else if (requested.insert(k).second) {
+          requests.push_back({cx, cy});
+          newRequests = true;
+        }
+      }
+
+      for (unique_ptr<MazeChunk>& chunk : finished)
+        ready.push_back(move(chunk));
+      finished.clear();
+    }
+    if (newRequests)
+      wake.notify_all();
+
+    for (int uploads = 0; uploads < maxUploads && uploadNext(); uploads++)
+      ;
+    evict();
+  }
+
+  // Envia para a GPU o próximo chunk pronto, descartando os que saíram do
+  // raio enquanto eram gerados. Devolve true se ainda restam chunks prontos.
+  bool uploadNext() {
+    while (!ready.empty()) {
+      unique_ptr<MazeChunk> chunk = move(ready.front());
+      ready.pop_front();
+      requested.erase(key(chunk->cx, chunk->cy));
+      if (!inRadius(chunk->cx, chunk->cy))
+        continue;
+
+      upload(*chunk);
+
+      // A geometria já está na GPU; só as caixas de colisão ficam na CPU
+      vector<PackedVertex>().swap(chunk->vertices);
+      vector<uint32_t>().swap(chunk->indices);
+
+      resident.push_front(move(*chunk));
+      residentIndex[key(resident.front().cx, resident.front().cy)] = resident.begin();
+      evict();
+      break;
+    }
+    return !ready.empty();
+  }
+
+  // Chunks gerados esperando o envio para a GPU
+  size_t getReadyCount() const {
+    return ready.size();
+  }
+
+  // Testa a esfera contra as paredes dos chunks residentes
+  bool collides(const collision::Sphere& sphere) const {
+    for (const MazeChunk& chunk : resident) {
+      if (!collision::testAABBSphere(chunk.bounds, sphere))
+        continue;
+      for (const collision::AABB& wall : chunk.walls)
+        if (collision::testAABBSphere(wall, sphere))
+          return true;
+    }
+    return false;
+  }
+
+  const list<MazeChunk>& getResident() const {
+    return resident;
+  }
+
+  // Chunks pedidos às threads ou prontos esperando o envio para a GPU
+  size_t getPendingCount() const {
+    return requested.size();
+  }
+
+  size_t getGpuBytes() const {
+    size_t bytes = 0;
+    for (const MazeChunk& chunk : resident)
+      bytes += chunk.gpu_bytes;
+    return bytes;
+  }
+
+  private:
+  static int64_t key(int cx, int cy) {
+    return static_cast<int64_t>(static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32 | static_cast<uint32_t>(cy));
+  }
+
+  bool inRadius(int cx, int cy) const {
+    return abs(cx - centerX) <= radius && abs(cy - centerY) <= radius;
+  }
+
+  // Os chunks dentro do raio estão no começo da lista, então o fim só tem
+  // chunks fora do raio enquanto o orçamento é respeitado
+  void evict() {
+    while (resident.size() > budget) {
+      MazeChunk& chunk = resident.back();
+      release(chunk);
+      residentIndex.erase(key(chunk.cx, chunk.cy));
+      resident.pop_back();
+    }
+  }
+
+  void workerLoop() {
+    while (true) {
+      pair<int, int> coords;
+      {
+        unique_lock<mutex> lock(queueMutex);
+        wake.wait(lock, [this] { return stopping || !requests.empty(); });
+        if (stopping)
+          return;
+        coords = requests.front();
+        requests.pop_front();
+      }
+
+      unique_ptr<MazeChunk> chunk(new MazeChunk());
+      chunk->cx = coords.first;
+      chunk->cy = coords.second;
+      BuildMazeChunk(seed, *chunk);
+
+      lock_guard<mutex> lock(queueMutex);
+      finished.push_back(move(chunk));
+    }
+  }
+
+  unsigned int  seed;
+  int           radius;
+  size_t        budget;
+  ChunkCallback upload;
+  ChunkCallback release;
+  int           centerX = 0;
+  int           centerY = 0;
+
+  vector<pair<int, int>> offsets;
+
+  // Thread principal apenas
+  list<MazeChunk>                                   resident;  // Mais recente primeiro
+  unordered_map<int64_t, list<MazeChunk>::iterator> residentIndex;
+  unordered_set<int64_t>                            requested; // Na fila, sendo gerados ou prontos
+  deque<unique_ptr<MazeChunk>>                      ready;
+
+  // Compartilhados com as threads, protegidos por queueMutex
+  mutex                         queueMutex;
+  condition_variable            wake;
+  deque<pair<int, int>>         requests;
+  vector<unique_ptr<MazeChunk>> finished;
+  bool                          stopping = false;
+
+  vector<thread> workers;
+};
+
+#endif // CHUNKS_HPP
@@ -0,0 +1,170 @@
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+#include "collisions.hpp"
+
+namespace culling {
+
+// Conjunto de caixas (AABB) guardado como "structure of arrays": cada
+// coordenada fica em um vetor contíguo, de forma que o teste contra o
+// frustum percorre memória sequencial e pode ser vetorizado pelo compilador.
+struct BoundsSoA {
+  std::vector<float> centerX, centerY, centerZ;
+  std::vector<float> extentX, extentY, extentZ;
+
+  void clear() {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+  }
+
+  void reserve(size_t n) {
+    centerX.reserve(n);
+    centerY.reserve(n);
+    centerZ.reserve(n);
+    extentX.reserve(n);
+    extentY.reserve(n);
+    extentZ.reserve(n);
+  }
+
+  void add(const collision::AABB& aabb) {
+    glm::vec3 center = (aabb.min + aabb.max) * 0.5f;
+    glm::vec3 extent = (aabb.max - aabb.min) * 0.5f;
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    extentX.push_back(extent.x);
+    extentY.push_back(extent.y);
+    extentZ.push_back(extent.z);
+  }
+
+  // Copia a caixa de índice i de outro conjunto
+  void add(const BoundsSoA& other, size_t i) {
+    centerX.push_back(other.centerX[i]);
+    centerY.push_back(other.centerY[i]);
+    centerZ.push_back(other.centerZ[i]);
+    extentX.push_back(other.extentX[i]);
+    extentY.push_back(other.extentY[i]);
+    extentZ.push_back(other.extentZ[i]);
+  }
+
+  size_t size() const {
+    return centerX.size();
+  }
+};
+
+// Transforma uma AABB pela matriz M e retorna a AABB (em coordenadas
+// globais) que a contém. O centro é transformado normalmente e a meia
+// largura é multiplicada pelo valor absoluto da parte linear de M (Arvo, 1990).
+collision::AABB transformAABB(const glm::mat4& M, const glm::vec3& bbox_min, const glm::vec3& bbox_max) {
+  glm::vec3 center = (bbox_min + bbox_max) * 0.5f;
+  glm::vec3 extent = (bbox_max - bbox_min) * 0.5f;
+
+  glm::vec3 newCenter = glm::vec3(M * glm::vec4(center, 1.0f));
+  glm::vec3 newExtent;
+  for (int row = 0; row < 3; row++) {
+    newExtent[row] = std::fabs(M[0][row]) * extent.x +
+                     std::fabs(M[1][row]) * extent.y +
+                     std::fabs(M[2][row]) * extent.z;
+  }
+
+  collision::AABB result;
+  result.min = newCenter - newExtent;
+  result.max = newCenter + newExtent;
+  return result;
+}
+
+// Maior fator de escala aplicado pela matriz M (norma da maior coluna da
+// parte linear). Serve para levar raios e erros do modelo para o mundo.
+float maxScale(const glm::mat4& M) {
+  return std::fmax(glm::length(glm::vec3(M[0])), std::fmax(glm::length(glm::vec3(M[1])), glm::length(glm::vec3(M[2]))));
+}
+
+// Testa todas as caixas de "bounds" contra os seis planos do frustum (veja
+// Camera::getFrustumPlanes()). Ao final, visible[i] == 1 se a caixa i
+// intersecta ou está dentro do frustum. Retorna o número de caixas visíveis.
+//
+// O laço externo percorre os planos e o interno as caixas, sem desvios, para
+// que o compilador gere código SIMD para o laço interno.
+size_t cullAABBs(const BoundsSoA& bounds, const collision::Plane* planes, std::vector<unsigned char>& visible) {
+  const size_t n = bounds.size();
+  visible.assign(n, 1);
+
+  const float*   cx  = bounds.centerX.data();
+  const float*   cy  = bounds.centerY.data();
+  const float*   cz  = bounds.centerZ.data();
+  const float*   ex  = bounds.extentX.data();
+  const float*   ey  = bounds.extentY.data();
+  const float*   ez  = bounds.extentZ.data();
+  unsigned char* out = visible.data();
+
+  for (int p = 0; p < 6; p++) {
+    const float nx = planes[p].normal.x;
+    const float ny = planes[p].normal.y;
+    const float nz = planes[p].normal.z;
+    const float d  = planes[p].distance;
+    const float ax = std::fabs(nx);
+    const float ay = std::fabs(ny);
+    const float az = std::fabs(nz);
+
+    for (size_t i = 0; i < n; i++) {
+      // Distância do centro ao plano e "raio" da caixa projetado na normal
+      float distance = nx * cx[i] + ny * cy[i] + nz * cz[i] - d;
+      float radius   = ax * ex[i] + ay * ey[i] + az * ez[i];
+      out[i] &= (unsigned char) (distance + radius >= 0.0f);
+    }
+  }
+
+  size_t numVisible = 0;
+  for (size_t i = 0; i < n; i++)
+    numVisible += out[i];
+
+  return numVisible;
+}
+
+// Descarta as caixas (visible[i] = 0) cuja distância ao ponto "point" é
+// maior que maxDistance. Deve ser chamada após cullAABBs(), sobre o mesmo
+// vetor "visible". Retorna o número de caixas que continuam visíveis.
+size_t cullAABBsByDistance(const BoundsSoA& bounds, const glm::vec3& point, float maxDistance, std::vector<unsigned char>& visible) {
+  const size_t   n              = bounds.size();
+  const float    maxDistanceSqr = maxDistance * maxDistance;
+  unsigned char* out            = visible.data();
+
+  for (size_t i = 0; i < n; i++) {
+    // Distância do ponto à caixa, eixo por eixo (zero se está dentro)
+    float dx = std::fmax(std::fabs(point.x - bounds.centerX[i]) - bounds.extentX[i], 0.0f);
+    float dy = std::fmax(std::fabs(point.y - bounds.centerY[i]) - bounds.extentY[i], 0.0f);
+    float dz = std::fmax(std::fabs(point.z - bounds.centerZ[i]) - bounds.extentZ[i], 0.0f);
+    out[i] &= (unsigned char) (dx * dx + dy * dy + dz * dz <= maxDistanceSqr);
+  }
+
+  size_t numVisible = 0;
+  for (size_t i = 0; i < n; i++)
+    numVisible += out[i];
+
+  return numVisible;
+}
+
+// Distância a partir da qual o fog exponencial quadrático do fragment shader,
+// exp(-(d * density)^2), deixa um fragmento indistinguível de fog_color em
+// 8 bits por canal (contribuição do objeto menor que meio degrau, 0.5/255).
+// Retorna infinito quando não há fog.
+float fogVisibilityDistance(float density) {
+  if (density <= 0.0f)
+    return std::numeric_limits<float>::infinity();
+
+  return std::sqrt(std::log(255.0f / 0.5f)) / density;
+}
+
+} // namespace culling
+
+#endif // CULLING_HPP
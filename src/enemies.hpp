@@ -0,0 +1,548 @@
+#ifndef ENEMIES_HPP
+#define ENEMIES_HPP
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+#include "hpa.hpp"
+#include "maze.hpp"
+#include "mazepaths.hpp"
+#include "spatialhash.hpp"
+#include "workerpool.hpp"
+
+// Inimigos processados por bloco: cada thread (de um WorkerPool criado na
+// primeira atualização paralela) pega um bloco e executa nele todas as fases
+// do quadro, sem sincronizar com as outras
+const size_t kEnemyBlockSize = 4096;
+
+// Abaixo disso a atualização roda só na thread principal
+const size_t kEnemyParallelThreshold = 8192;
+
+// Lado das células do labirinto, usadas como chave do hash espacial
+const float kEnemyHashCellSize = 2.0f;
+
+// Linha de visão ainda não calculada
+const uint64_t kEnemyNoSight = UINT64_MAX;
+
+// Níveis de detalhe da IA. Inimigos a até kEnemyNearRadius do jogador são
+// atualizados a cada quadro; os que estão a até kEnemyMidRadius ou foram
+// desenhados no último quadro, a cada kEnemyMidInterval quadros; os demais,
+// a cada kEnemyFarInterval quadros (múltiplo de kEnemyMidInterval).
+const float    kEnemyNearRadius   = 16.0f;
+const float    kEnemyMidRadius    = 40.0f;
+const uint32_t kEnemyMidInterval  = 4;
+const uint32_t kEnemyFarInterval  = 16;
+const uint8_t  kEnemyTierNear     = 0;
+const uint8_t  kEnemyTierMid      = 1;
+const uint8_t  kEnemyTierFar      = 2;
+
+// Inimigos guardados como "structure of arrays". Os campos lidos e escritos a
+// cada quadro (posição, temporizador, células, estado) ficam separados dos
+// usados só na hora de decidir o próximo movimento ou de desenhar, de forma
+// que as fases percorrem vetores contíguos e podem ser vetorizadas.
+//
+// update() separa o quadro em fases: detecção do jogador, decisão (só para
+// os inimigos parados cujo temporizador venceu), interpolação da posição e
+// chegadas. Os inimigos que dependem de MazeHPA, que não pode ser usada por
+// várias threads ao mesmo tempo, decidem depois, em série.
+//
+// Nem todos os inimigos são atualizados em todo quadro (veja os níveis de
+// detalhe acima): cada um avança o tempo passado desde a sua última
+// atualização, e os quadros de cada nível são distribuídos pelo índice do
+// inimigo, então o custo por quadro depende dos inimigos próximos, e não do
+// total. getTransform() extrapola a posição até o quadro atual, de forma que
+// os inimigos distantes não andam aos saltos, e calcula a onda só para quem
+// é desenhado.
+//
+// A detecção exige, além do raio, linha de visão entre a célula do inimigo e
+// a do jogador (MazeGenerator::hasLineOfSight()), guardada em cache por
+// inimigo: nos corredores as duas células mudam pouco e quase toda consulta
+// reaproveita o resultado anterior.
+//
+// Os inimigos ficam em um hash espacial com a sua célula do labirinto como
+// chave, usado pela detecção do jogador e pelas consultas de vizinhança
+// (colisão, separação entre inimigos). Como a célula só muda ao fim de cada
+// passo, o hash é atualizado apenas para quem chegou a uma célula nova.
+class EnemySystem {
+  public:
+  // Dados lidos ou escritos a cada quadro
+  struct HotData {
+    vector<float>   posX, posZ;   // Posição no mundo (os inimigos ficam em y = 0)
+    vector<float>   fromX, fromZ; // Centro da célula atual
+    vector<float>   toX, toZ;     // Centro da célula de destino (igual à atual se parado)
+    vector<float>   timer;        // Tempo desde o último movimento
+    vector<float>   moveSpeed;    // Duração de um passo patrulhando
+    vector<float>   chaseSpeed;   // Duração de um passo perseguindo
+    vector<float>   radiusSq;     // Raio de detecção ao quadrado
+    vector<int32_t> cellX, cellY;
+    vector<int32_t>  targetCellX, targetCellY;
+    vector<uint8_t>  moving;
+    vector<uint8_t>  chasing;
+    vector<double>   lastUpdate;   // Relógio da última atualização
+    vector<uint8_t>  tier;         // Nível de detalhe
+    vector<uint32_t> updatedFrame; // Último quadro em que foi atualizado
+  };
+
+  // Dados usados só na decisão ou no desenho
+  struct ColdData {
+    vector<uint8_t>     colorType;        // 0 = vermelho, 1 = azul
+    vector<float>       waveSin, waveCos; // Seno e cosseno da fase da onda
+    vector<float>       rotationY;
+    vector<uint32_t>    rng; // Estado xorshift de cada inimigo
+    vector<MazeHPAPath> chasePath;
+    vector<uint64_t>    sightKey;     // Células (inimigo, jogador) da última linha de visão
+    vector<uint8_t>     sightVisible; // Resultado dela
+    vector<uint32_t>    drawnFrame;   // Último quadro em que foi desenhado
+  };
+
+  // As threads de trabalho são mantidas
+  void clear() {
+    unique_ptr<WorkerPool> keep = move(pool);
+    *this                       = EnemySystem();
+    pool                        = move(keep);
+  }
+
+  size_t size() const {
+    return hot.posX.size();
+  }
+
+  bool empty() const {
+    return hot.posX.empty();
+  }
+
+  // Adiciona um inimigo parado na célula (cellX, cellY)
+  void add(const MazeGenerator& maze, int cellX, int cellY, int colorType, float rotationY, float waveOffset,
+           float moveSpeed, float chaseSpeed, float detectionRadius, uint32_t seed) {
+    pair<float, float> world = maze.cellToWorldCoords(cellX, cellY);
+
+    hot.posX.push_back(world.first);
+    hot.posZ.push_back(world.second);
+    hot.fromX.push_back(world.first);
+    hot.fromZ.push_back(world.second);
+    hot.toX.push_back(world.first);
+    hot.toZ.push_back(world.second);
+    hot.timer.push_back(0.0f);
+    hot.moveSpeed.push_back(moveSpeed);
+    hot.chaseSpeed.push_back(chaseSpeed);
+    hot.radiusSq.push_back(detectionRadius * detectionRadius);
+    maxDetectionRadius = max(maxDetectionRadius, detectionRadius);
+    hashDirty          = true;
+    hot.cellX.push_back(cellX);
+    hot.cellY.push_back(cellY);
+    hot.targetCellX.push_back(cellX);
+    hot.targetCellY.push_back(cellY);
+    hot.moving.push_back(0);
+    hot.chasing.push_back(0);
+    hot.lastUpdate.push_back(clock);
+    hot.tier.push_back(kEnemyTierNear);
+    hot.updatedFrame.push_back(frameIndex);
+
+    cold.colorType.push_back(static_cast<uint8_t>(colorType));
+    cold.waveSin.push_back(sin(waveOffset));
+    cold.waveCos.push_back(cos(waveOffset));
+    cold.rotationY.push_back(rotationY);
+    cold.rng.push_back(seed != 0 ? seed : 1);
+    cold.chasePath.push_back(MazeHPAPath());
+    cold.sightKey.push_back(kEnemyNoSight);
+    cold.sightVisible.push_back(0);
+    cold.drawnFrame.push_back(frameIndex);
+  }
+
+  // Avança o relógio dos inimigos em deltaTime segundos e atualiza os que
+  // estão no seu quadro. "time" só anima a onda do desenho. Os caminhos de
+  // "paths" são usados quando valem (isFast()), senão os de "hpa".
+  void update(float deltaTime, float time, const glm::vec3& player, const MazeGenerator& maze,
+              const MazeTreePaths& paths, MazeHPA& hpa, unsigned int numThreads = thread::hardware_concurrency()) {
+    const size_t n = size();
+    clock += deltaTime;
+
+    // Listas do quadro com espaço para todos, para não alocar em regime
+    active.reserve(n);
+    chasingList.reserve(n);
+    frameIndex++;
+    waveSin = 0.2f * sin(time * 2.0f);
+    waveCos = 0.2f * cos(time * 2.0f);
+
+    Frame frame;
+    frame.deltaTime    = deltaTime;
+    frame.time         = time;
+    frame.player       = player;
+    frame.maze         = &maze;
+    frame.treePaths    = paths.isFast() ? &paths : NULL;
+    frame.playerInMaze = maze.worldToCell(player.x, player.z, frame.playerCellX, frame.playerCellY);
+
+    // Detecção: só os inimigos perto do jogador são testados, e só veem o
+    // jogador se não há parede entre as duas células. A linha de visão de
+    // cada inimigo é refeita apenas quando a sua célula ou a do jogador muda
+    // (ou quando o labirinto muda).
+    if (maze.getRevision() != sightRevision) {
+      fill(cold.sightKey.begin(), cold.sightKey.end(), kEnemyNoSight);
+      sightRevision = maze.getRevision();
+    }
+
+    const float    dy2       = player.y * player.y;
+    const uint64_t playerKey = cellKey(frame.playerCellX, frame.playerCellY);
+    rebuildHashIfDirty();
+    for (uint32_t i : chasingList)
+      hot.chasing[i] = 0;
+    chasingList.clear();
+
+    // Os inimigos próximos, que incluem todos os que podem detectar o
+    // jogador, são atualizados neste quadro
+    active.clear();
+    spatialHash.forEachInRadius(player.x, player.z, max(kEnemyNearRadius, maxDetectionRadius), hot.posX.data(), hot.posZ.data(), [&](uint32_t i, float d2) {
+      active.push_back(i);
+      hot.updatedFrame[i] = frameIndex;
+      hot.tier[i]         = kEnemyTierNear;
+      if (d2 + dy2 > hot.radiusSq[i])
+        return;
+
+      uint64_t key = cellKey(hot.cellX[i], hot.cellY[i]) << 32 | playerKey;
+      if (cold.sightKey[i] != key) {
+        cold.sightKey[i]     = key;
+        cold.sightVisible[i] = maze.hasLineOfSight(hot.cellX[i], hot.cellY[i], frame.playerCellX, frame.playerCellY);
+        sightTests++;
+      } else {
+        sightHits++;
+      }
+      hot.chasing[i] = cold.sightVisible[i];
+      if (hot.chasing[i])
+        chasingList.push_back(i);
+    });
+
+    // Os demais, pelo índice: a cada kEnemyMidInterval quadros passamos por
+    // todos, e os distantes só são atualizados em uma dessas passagens a cada
+    // kEnemyFarInterval quadros. Quem estava perto e se afastou conta como
+    // nível intermediário até ser reclassificado.
+    const uint32_t farPhase = frameIndex % kEnemyFarInterval;
+    for (size_t i = frameIndex % kEnemyMidInterval; i < n; i += kEnemyMidInterval) {
+      if (hot.updatedFrame[i] == frameIndex || (hot.tier[i] == kEnemyTierFar && i % kEnemyFarInterval != farPhase))
+        continue;
+      if (hot.tier[i] == kEnemyTierNear)
+        hot.tier[i] = kEnemyTierMid;
+      hot.updatedFrame[i] = frameIndex;
+      active.push_back(static_cast<uint32_t>(i));
+    }
+
+    const size_t count     = active.size();
+    const size_t numBlocks = (count + kEnemyBlockSize - 1) / kEnemyBlockSize;
+    numThreads             = (count < kEnemyParallelThreshold) ? 1 : max(1u, min(numThreads, static_cast<unsigned int>(numBlocks)));
+    if (numThreads > 1 && !pool)
+      pool.reset(new WorkerPool(numThreads));
+    if (pool)
+      numThreads = min(numThreads, pool->size());
+    lists.resize(max(lists.size(), static_cast<size_t>(numThreads)));
+
+    atomic<size_t> nextBlock(0);
+    auto           worker = [&](unsigned int slot) {
+      lists[slot].deferred.clear();
+      lists[slot].arrived.clear();
+      lists[slot].deferred.reserve(n);
+      lists[slot].arrived.reserve(n);
+      for (size_t block = nextBlock++; block < numBlocks; block = nextBlock++)
+        updateList(frame, &active[block * kEnemyBlockSize], &active[0] + min(count, (block + 1) * kEnemyBlockSize), lists[slot]);
+    };
+
+    if (numThreads > 1)
+      pool->run(numThreads, worker);
+    else
+      worker(0);
+
+    // Perseguições por MazeHPA. Esses inimigos estavam parados, então a
+    // interpolação do quadro não os afetou.
+    for (unsigned int slot = 0; slot < numThreads; slot++) {
+      const WorkerLists& list = lists[slot];
+      for (uint32_t i : list.deferred) {
+        int stepX, stepY;
+        if (hpa.nextStep(cold.chasePath[i], hot.cellX[i], hot.cellY[i], frame.playerCellX, frame.playerCellY, stepX, stepY))
+          takeStep(maze, i, stepX, stepY);
+        else
+          chaseDirectly(frame, i);
+      }
+      for (uint32_t i : list.arrived)
+        spatialHash.move(i, hot.cellX[i], hot.cellY[i]);
+    }
+  }
+
+  // Chama f(índice, distância ao quadrado no plano XZ) para cada inimigo a
+  // até "radius" de "center"
+  template <typename F>
+  void forEachNear(const glm::vec3& center, float radius, F f) {
+    rebuildHashIfDirty();
+    spatialHash.forEachInRadius(center.x, center.z, radius, hot.posX.data(), hot.posZ.data(), f);
+  }
+
+  // Outros inimigos a até "radius" do inimigo i
+  template <typename F>
+  void forEachNeighbor(size_t i, float radius, F f) {
+    rebuildHashIfDirty();
+    spatialHash.forEachInRadius(hot.posX[i], hot.posZ[i], radius, hot.posX.data(), hot.posZ.data(), [&](uint32_t j, float d2) {
+      if (j != i)
+        f(j, d2);
+    });
+  }
+
+  // Inimigo mais próximo de "position" a até maxRadius (exceto "exclude"), ou -1
+  int nearest(const glm::vec3& position, float maxRadius, int exclude = -1) {
+    rebuildHashIfDirty();
+    return spatialHash.nearest(position.x, position.z, maxRadius, hot.posX.data(), hot.posZ.data(), exclude);
+  }
+
+  // Transformação do inimigo i para o desenho: (x, y com a onda, z, rotação
+  // em Y), com a posição extrapolada do tempo passado desde a sua última
+  // atualização
+  glm::vec4 getTransform(size_t i) const {
+    float elapsed  = hot.timer[i] + static_cast<float>(clock - hot.lastUpdate[i]);
+    float speed    = hot.chasing[i] ? hot.chaseSpeed[i] : hot.moveSpeed[i];
+    float progress = min(elapsed / speed, 1.0f);
+    float x        = hot.fromX[i] + (hot.toX[i] - hot.fromX[i]) * progress;
+    float z        = hot.fromZ[i] + (hot.toZ[i] - hot.fromZ[i]) * progress;
+    float wave     = waveSin * cold.waveCos[i] + waveCos * cold.waveSin[i];
+    return glm::vec4(x, wave, z, cold.rotationY[i]);
+  }
+
+  // Avisa que o inimigo i foi desenhado neste quadro, o que o mantém pelo
+  // menos no nível intermediário de detalhe
+  void markDrawn(size_t i) {
+    cold.drawnFrame[i] = frameIndex;
+  }
+
+  // Inimigos atualizados no último update()
+  size_t getUpdatedCount() const {
+    return active.size();
+  }
+
+  glm::vec3 getPosition(size_t i) const {
+    return glm::vec3(hot.posX[i], 0.0f, hot.posZ[i]);
+  }
+
+  int getCellX(size_t i) const {
+    return hot.cellX[i];
+  }
+
+  int getCellY(size_t i) const {
+    return hot.cellY[i];
+  }
+
+  int getTargetCellX(size_t i) const {
+    return hot.targetCellX[i];
+  }
+
+  int getTargetCellY(size_t i) const {
+    return hot.targetCellY[i];
+  }
+
+  bool isChasing(size_t i) const {
+    return hot.chasing[i] != 0;
+  }
+
+  // Linhas de visão calculadas e reaproveitadas do cache desde o início
+  size_t getSightTests() const {
+    return sightTests;
+  }
+
+  size_t getSightHits() const {
+    return sightHits;
+  }
+
+  // Inimigos vermelhos ou perseguindo matam o jogador (e são desenhados em vermelho)
+  bool isDangerous(size_t i) const {
+    return cold.colorType[i] == 0 || hot.chasing[i] != 0;
+  }
+
+  private:
+  struct Frame {
+    float                deltaTime;
+    float                time;
+    glm::vec3            player;
+    const MazeGenerator* maze;
+    const MazeTreePaths* treePaths; // NULL se os caminhos da árvore não valem
+    bool                 playerInMaze;
+    int                  playerCellX, playerCellY;
+  };
+
+  // Listas preenchidas por uma thread e processadas depois, em série
+  struct WorkerLists {
+    vector<uint32_t> deferred; // Perseguições que dependem de MazeHPA
+    vector<uint32_t> arrived;  // Mudaram de célula (hash espacial)
+  };
+
+  void updateList(const Frame& frame, const uint32_t* begin, const uint32_t* end, WorkerLists& list) {
+    HotData& h = hot;
+
+    for (const uint32_t* it = begin; it != end; ++it) {
+      uint32_t i      = *it;
+      h.timer[i]      += static_cast<float>(clock - h.lastUpdate[i]);
+      h.lastUpdate[i] = clock;
+    }
+
+    // Decisão, só para quem está parado e já esperou o suficiente
+    for (const uint32_t* it = begin; it != end; ++it) {
+      uint32_t i = *it;
+      if (h.moving[i] || h.timer[i] < (h.chasing[i] ? h.chaseSpeed[i] : h.moveSpeed[i]))
+        continue;
+
+      if (!h.chasing[i]) {
+        wander(frame, i);
+      } else if (frame.playerInMaze && frame.treePaths == NULL) {
+        list.deferred.push_back(i);
+      } else {
+        int stepX, stepY;
+        if (frame.playerInMaze &&
+            frame.treePaths->nextStep(h.cellX[i], h.cellY[i], frame.playerCellX, frame.playerCellY, stepX, stepY))
+          takeStep(*frame.maze, i, stepX, stepY);
+        else
+          chaseDirectly(frame, i);
+      }
+    }
+
+    // Interpolação. Parados têm origem igual ao destino, então a conta vale
+    // para todos sem desvios.
+    for (const uint32_t* it = begin; it != end; ++it) {
+      uint32_t i        = *it;
+      float    speed    = h.chasing[i] ? h.chaseSpeed[i] : h.moveSpeed[i];
+      float    progress = min(h.timer[i] / speed, 1.0f);
+      h.posX[i]         = h.fromX[i] + (h.toX[i] - h.fromX[i]) * progress;
+      h.posZ[i]         = h.fromZ[i] + (h.toZ[i] - h.fromZ[i]) * progress;
+    }
+
+    // Chegadas ao destino e nível de detalhe para as próximas atualizações
+    const float midRadiusSq = kEnemyMidRadius * kEnemyMidRadius;
+    for (const uint32_t* it = begin; it != end; ++it) {
+      uint32_t i = *it;
+      if (h.tier[i] != kEnemyTierNear) {
+        float dx  = h.posX[i] - frame.player.x;
+        float dz  = h.posZ[i] - frame.player.z;
+        h.tier[i] = (dx * dx + dz * dz < midRadiusSq || frameIndex - cold.drawnFrame[i] <= 1) ? kEnemyTierMid : kEnemyTierFar;
+      }
+
+      if (!h.moving[i] || h.timer[i] < (h.chasing[i] ? h.chaseSpeed[i] : h.moveSpeed[i]))
+        continue;
+      h.cellX[i]  = h.targetCellX[i];
+      h.cellY[i]  = h.targetCellY[i];
+      h.fromX[i]  = h.toX[i];
+      h.fromZ[i]  = h.toZ[i];
+      h.moving[i] = 0;
+      h.timer[i]  = 0.0f;
+      list.arrived.push_back(i);
+    }
+  }
+
+  // Chave de 32 bits de uma célula (que pode estar fora do labirinto)
+  static uint64_t cellKey(int x, int y) {
+    return static_cast<uint64_t>(static_cast<uint16_t>(x)) | static_cast<uint64_t>(static_cast<uint16_t>(y)) << 16;
+  }
+
+  // Inimigos foram adicionados depois do último update()
+  void rebuildHashIfDirty() {
+    if (hashDirty)
+      spatialHash.build(hot.cellX.data(), hot.cellY.data(), size());
+    hashDirty = false;
+  }
+
+  // Vizinhos alcançáveis da célula atual do inimigo; retorna quantos
+  int neighbors(const MazeGenerator& maze, size_t i, int* nx, int* ny) const {
+    const int dx[4] = {0, 0, 1, -1};
+    const int dy[4] = {-1, 1, 0, 0};
+    const int x     = hot.cellX[i];
+    const int y     = hot.cellY[i];
+
+    int count = 0;
+    for (int dir = 0; dir < 4; dir++) {
+      if (maze.isValidPosition(x + dx[dir], y + dy[dir]) && !maze.hasWall(x, y, dir)) {
+        nx[count] = x + dx[dir];
+        ny[count] = y + dy[dir];
+        count++;
+      }
+    }
+    return count;
+  }
+
+  // Começa a andar até a célula vizinha (x, y)
+  void startMove(const MazeGenerator& maze, size_t i, int x, int y) {
+    pair<float, float> world = maze.cellToWorldCoords(x, y);
+
+    hot.targetCellX[i] = x;
+    hot.targetCellY[i] = y;
+    hot.toX[i]         = world.first;
+    hot.toZ[i]         = world.second;
+    hot.moving[i]      = 1;
+    hot.timer[i]       = 0.0f;
+    cold.rotationY[i]  = atan2(static_cast<float>(x - hot.cellX[i]), static_cast<float>(y - hot.cellY[i]));
+  }
+
+  // Passo do caminho até o jogador; na mesma célula dele o inimigo só espera
+  void takeStep(const MazeGenerator& maze, size_t i, int stepX, int stepY) {
+    hot.timer[i] = 0.0f;
+    if (stepX != hot.cellX[i] || stepY != hot.cellY[i])
+      startMove(maze, i, stepX, stepY);
+  }
+
+  // Fora do labirinto: vizinho mais alinhado com a direção do jogador
+  void chaseDirectly(const Frame& frame, size_t i) {
+    int nx[4], ny[4];
+    int count = neighbors(*frame.maze, i, nx, ny);
+    if (count == 0)
+      return;
+
+    glm::vec3 position          = getPosition(i);
+    glm::vec3 directionToPlayer = glm::normalize(frame.player - position);
+
+    int   best    = 0;
+    float bestDot = -2.0f;
+    for (int k = 0; k < count; k++) {
+      pair<float, float> world = frame.maze->cellToWorldCoords(nx[k], ny[k]);
+      float              dot   = glm::dot(directionToPlayer, glm::normalize(glm::vec3(world.first, 0.0f, world.second) - position));
+      if (dot > bestDot) {
+        bestDot = dot;
+        best    = k;
+      }
+    }
+    startMove(*frame.maze, i, nx[best], ny[best]);
+  }
+
+  // Patrulha: vizinho aleatório
+  void wander(const Frame& frame, size_t i) {
+    int nx[4], ny[4];
+    int count = neighbors(*frame.maze, i, nx, ny);
+    if (count == 0)
+      return;
+
+    uint32_t& state = cold.rng[i];
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    int k = state % count;
+    startMove(*frame.maze, i, nx[k], ny[k]);
+  }
+
+  HotData             hot;
+  ColdData            cold;
+  unique_ptr<WorkerPool> pool;        // Criado na primeira atualização paralela
+  vector<WorkerLists>    lists;       // Uma por thread
+  vector<uint32_t>       active;      // Atualizados neste quadro
+  vector<uint32_t>       chasingList; // Com "chasing" ligado
+
+  double   clock      = 0.0; // Soma dos deltaTime recebidos
+  uint32_t frameIndex = 0;
+  float    waveSin    = 0.0f; // 0.2 * sin(2t) e 0.2 * cos(2t) do quadro, para a onda
+  float    waveCos    = 0.0f;
+
+  // Um inimigo andando está a até uma célula da célula de origem, a chave
+  SpatialHash spatialHash        = SpatialHash(kEnemyHashCellSize, kEnemyHashCellSize);
+  bool        hashDirty          = true;
+  float       maxDetectionRadius = 0.0f;
+
+  unsigned int sightRevision = 0; // Versão do labirinto das linhas de visão em cache
+  size_t       sightTests    = 0;
+  size_t       sightHits     = 0;
+};
+
+#endif // ENEMIES_HPP
@@ -0,0 +1,312 @@
+#ifndef GLINSTRUMENT_HPP
+#define GLINSTRUMENT_HPP
+
+// Camada sobre as funções OpenGL usadas pelo programa. Precisa ser incluído
+// depois de <glad/glad.h>, em todo arquivo que faz essas chamadas.
+//
+// As mudanças de estado (programa, VAO, texturas, blend, depth, cull e
+// uniforms) passam sempre por GLStateCache (veja "glstate.hpp"), que pula as
+// que não mudariam nada. Nas compilações de depuração (sem NDEBUG), a não ser
+// que GL_INSTRUMENTATION_DISABLED esteja definida, cada chamada de desenho,
+// de uniform, de bind, de envio de dados e de estado também é contada em
+// GLCallStats (veja "glstats.hpp") pelo ponto do código que a fez, inclusive
+// as que o cache evitou.
+
+#include <cstdint>
+#include <glad/glad.h>
+#include "glstate.hpp"
+#include "glstats.hpp"
+
+// Definidos em main.cpp
+extern GLStateCache g_GLState;
+extern GLCallStats  g_GLStats;
+
+#if !defined(NDEBUG) && !defined(GL_INSTRUMENTATION_DISABLED)
+
+const bool kGLInstrumented = true;
+
+// Índice do ponto do código (arquivo e linha) onde a macro aparece,
+// registrado na primeira vez que ele é executado
+#define GL_CALL_SITE(type) \
+  ([]() -> size_t { static size_t site = g_GLStats.addSite(__FILE__, __LINE__, type); return site; }())
+
+#else
+
+const bool kGLInstrumented = false;
+
+#define GL_CALL_SITE(type) static_cast<size_t>(0)
+
+#endif
+
+inline void GLCount(size_t site, size_t bytes = 0, bool redundant = false) {
+  if (kGLInstrumented)
+    g_GLStats.call(site, bytes, redundant);
+}
+
+// Conta uma mudança de estado já passada pelo cache e diz se ela deve ir
+// para o GL
+inline bool GLChange(size_t site, bool changed) {
+  GLCount(site, 0, !changed);
+  return changed;
+}
+
+// Estado do cache para um glEnable/glDisable, ou -1 se ele não é acompanhado
+inline int GLCapabilityState(GLenum cap) {
+  switch (cap) {
+  case GL_BLEND:
+    return kGLCacheBlend;
+  case GL_DEPTH_TEST:
+    return kGLCacheDepthTest;
+  case GL_CULL_FACE:
+    return kGLCacheCullFace;
+  default:
+    return -1;
+  }
+}
+
+// Bytes de uma imagem de 8 bits por canal
+inline size_t GLImageBytes(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+  if (type != GL_UNSIGNED_BYTE)
+    return 0;
+  size_t channels = (format == GL_RED) ? 1 : (format == GL_RG) ? 2 : (format == GL_RGB) ? 3 : (format == GL_RGBA) ? 4 : 0;
+  return static_cast<size_t>(width) * height * channels;
+}
+
+// Desenho
+inline void GLDrawElements(size_t site, GLenum mode, GLsizei count, GLenum type, const void* indices) {
+  GLCount(site);
+  glad_glDrawElements(mode, count, type, indices);
+}
+
+inline void GLDrawArrays(size_t site, GLenum mode, GLint first, GLsizei count) {
+  GLCount(site);
+  glad_glDrawArrays(mode, first, count);
+}
+
+inline void GLMultiDrawElements(size_t site, GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei drawcount) {
+  GLCount(site);
+  glad_glMultiDrawElements(mode, count, type, indices, drawcount);
+}
+
+// Uniforms, comparados byte a byte com o último valor no programa atual
+inline void GLUniform1i(size_t site, GLint location, GLint v0) {
+  if (GLChange(site, g_GLState.setUniform(location, &v0, sizeof(v0))))
+    glad_glUniform1i(location, v0);
+}
+
+inline void GLUniform1f(size_t site, GLint location, GLfloat v0) {
+  if (GLChange(site, g_GLState.setUniform(location, &v0, sizeof(v0))))
+    glad_glUniform1f(location, v0);
+}
+
+inline void GLUniform3fv(size_t site, GLint location, GLsizei count, const GLfloat* value) {
+  if (GLChange(site, g_GLState.setUniform(location, value, count * 3 * sizeof(GLfloat))))
+    glad_glUniform3fv(location, count, value);
+}
+
+inline void GLUniform4f(size_t site, GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+  GLfloat value[4] = {v0, v1, v2, v3};
+  if (GLChange(site, g_GLState.setUniform(location, value, sizeof(value))))
+    glad_glUniform4f(location, v0, v1, v2, v3);
+}
+
+inline void GLUniform4fv(size_t site, GLint location, GLsizei count, const GLfloat* value) {
+  if (GLChange(site, g_GLState.setUniform(location, value, count * 4 * sizeof(GLfloat))))
+    glad_glUniform4fv(location, count, value);
+}
+
+// Matrizes transpostas não são comparadas: o valor guardado no programa não
+// seria o que foi passado
+inline void GLUniformMatrix4fv(size_t site, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+  if (GLChange(site, transpose != GL_FALSE || g_GLState.setUniform(location, value, count * 16 * sizeof(GLfloat))))
+    glad_glUniformMatrix4fv(location, count, transpose, value);
+}
+
+// Binds. Buffers e samplers não passam pelo cache, só são contados; o
+// GL_ELEMENT_ARRAY_BUFFER faz parte do VAO, então é guardado por VAO.
+inline void GLUseProgram(size_t site, GLuint program) {
+  if (GLChange(site, g_GLState.set(kGLCacheProgram, program)))
+    glad_glUseProgram(program);
+}
+
+inline void GLBindVertexArray(size_t site, GLuint array) {
+  if (GLChange(site, g_GLState.set(kGLCacheVertexArray, array)))
+    glad_glBindVertexArray(array);
+}
+
+inline void GLBindBuffer(size_t site, GLenum target, GLuint buffer) {
+  if (kGLInstrumented) {
+    uint64_t slot = target;
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+      slot |= g_GLState.get(kGLCacheVertexArray) << 32;
+    GLCount(site, 0, g_GLStats.setState(kGLStateBuffer, slot, buffer));
+  }
+  glad_glBindBuffer(target, buffer);
+}
+
+inline void GLActiveTexture(size_t site, GLenum texture) {
+  if (GLChange(site, g_GLState.set(kGLCacheActiveTexture, texture - GL_TEXTURE0)))
+    glad_glActiveTexture(texture);
+}
+
+inline void GLBindTexture(size_t site, GLenum target, GLuint texture) {
+  if (GLChange(site, target != GL_TEXTURE_2D || g_GLState.setTexture(texture)))
+    glad_glBindTexture(target, texture);
+}
+
+inline void GLBindSampler(size_t site, GLuint unit, GLuint sampler) {
+  if (kGLInstrumented)
+    GLCount(site, 0, g_GLStats.setState(kGLStateSampler, unit, sampler));
+  glad_glBindSampler(unit, sampler);
+}
+
+// Envio de dados
+inline void GLBufferData(size_t site, GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+  GLCount(site, static_cast<size_t>(size));
+  glad_glBufferData(target, size, data, usage);
+}
+
+inline void GLBufferSubData(size_t site, GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+  GLCount(site, static_cast<size_t>(size));
+  glad_glBufferSubData(target, offset, size, data);
+}
+
+inline void GLTexImage2D(size_t site, GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                         GLint border, GLenum format, GLenum type, const void* pixels) {
+  GLCount(site, (pixels != NULL) ? GLImageBytes(width, height, format, type) : 0);
+  glad_glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+}
+
+// Estado fixo
+inline void GLEnable(size_t site, GLenum cap) {
+  int state = GLCapabilityState(cap);
+  if (GLChange(site, state < 0 || g_GLState.set(static_cast<GLCachedState>(state), 1)))
+    glad_glEnable(cap);
+}
+
+inline void GLDisable(size_t site, GLenum cap) {
+  int state = GLCapabilityState(cap);
+  if (GLChange(site, state < 0 || g_GLState.set(static_cast<GLCachedState>(state), 0)))
+    glad_glDisable(cap);
+}
+
+inline void GLBlendFunc(size_t site, GLenum sfactor, GLenum dfactor) {
+  if (GLChange(site, g_GLState.set(kGLCacheBlendFunc, static_cast<uint64_t>(sfactor) << 32 | dfactor)))
+    glad_glBlendFunc(sfactor, dfactor);
+}
+
+inline void GLDepthFunc(size_t site, GLenum func) {
+  if (GLChange(site, g_GLState.set(kGLCacheDepthFunc, func)))
+    glad_glDepthFunc(func);
+}
+
+inline void GLCullFace(size_t site, GLenum mode) {
+  if (GLChange(site, g_GLState.set(kGLCacheCullMode, mode)))
+    glad_glCullFace(mode);
+}
+
+inline void GLFrontFace(size_t site, GLenum mode) {
+  if (GLChange(site, g_GLState.set(kGLCacheFrontFace, mode)))
+    glad_glFrontFace(mode);
+}
+
+// O perfil core só aceita GL_FRONT_AND_BACK, então há um único modo
+inline void GLPolygonMode(size_t site, GLenum face, GLenum mode) {
+  if (GLChange(site, face != GL_FRONT_AND_BACK || g_GLState.set(kGLCachePolygonMode, mode)))
+    glad_glPolygonMode(face, mode);
+}
+
+// Programas religados ou apagados perdem os uniforms, e objetos apagados
+// desfazem as ligações. Estas chamadas não são contadas.
+inline void GLLinkProgram(GLuint program) {
+  g_GLState.forgetProgram(program);
+  glad_glLinkProgram(program);
+}
+
+inline void GLDeleteProgram(GLuint program) {
+  g_GLState.forgetProgram(program);
+  glad_glDeleteProgram(program);
+}
+
+inline void GLDeleteBuffers(GLsizei n, const GLuint* buffers) {
+  if (kGLInstrumented)
+    for (GLsizei i = 0; i < n; i++)
+      g_GLStats.forgetValue(kGLStateBuffer, buffers[i]);
+  glad_glDeleteBuffers(n, buffers);
+}
+
+inline void GLDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+  for (GLsizei i = 0; i < n; i++)
+    g_GLState.forgetVertexArray(arrays[i]);
+  glad_glDeleteVertexArrays(n, arrays);
+}
+
+inline void GLDeleteTextures(GLsizei n, const GLuint* textures) {
+  for (GLsizei i = 0; i < n; i++)
+    g_GLState.forgetTexture(textures[i]);
+  glad_glDeleteTextures(n, textures);
+}
+
+#undef glDrawElements
+#undef glDrawArrays
+#undef glMultiDrawElements
+#undef glUniform1i
+#undef glUniform1f
+#undef glUniform3fv
+#undef glUniform4f
+#undef glUniform4fv
+#undef glUniformMatrix4fv
+#undef glUseProgram
+#undef glBindVertexArray
+#undef glBindBuffer
+#undef glActiveTexture
+#undef glBindTexture
+#undef glBindSampler
+#undef glBufferData
+#undef glBufferSubData
+#undef glTexImage2D
+#undef glEnable
+#undef glDisable
+#undef glBlendFunc
+#undef glDepthFunc
+#undef glCullFace
+#undef glFrontFace
+#undef glPolygonMode
+#undef glLinkProgram
+#undef glDeleteProgram
+#undef glDeleteBuffers
+#undef glDeleteVertexArrays
+#undef glDeleteTextures
+
+#define glDrawElements(...)       GLDrawElements(GL_CALL_SITE(kGLCallDraw), __VA_ARGS__)
+#define glDrawArrays(...)         GLDrawArrays(GL_CALL_SITE(kGLCallDraw), __VA_ARGS__)
+#define glMultiDrawElements(...)  GLMultiDrawElements(GL_CALL_SITE(kGLCallDraw), __VA_ARGS__)
+#define glUniform1i(...)          GLUniform1i(GL_CALL_SITE(kGLCallUniform), __VA_ARGS__)
+#define glUniform1f(...)          GLUniform1f(GL_CALL_SITE(kGLCallUniform), __VA_ARGS__)
+#define glUniform3fv(...)         GLUniform3fv(GL_CALL_SITE(kGLCallUniform), __VA_ARGS__)
+#define glUniform4f(...)          GLUniform4f(GL_CALL_SITE(kGLCallUniform), __VA_ARGS__)
+#define glUniform4fv(...)         GLUniform4fv(GL_CALL_SITE(kGLCallUniform), __VA_ARGS__)
+#define glUniformMatrix4fv(...)   GLUniformMatrix4fv(GL_CALL_SITE(kGLCallUniform), __VA_ARGS__)
+#define glUseProgram(...)         GLUseProgram(GL_CALL_SITE(kGLCallBind), __VA_ARGS__)
+#define glBindVertexArray(...)    GLBindVertexArray(GL_CALL_SITE(kGLCallBind), __VA_ARGS__)
+#define glBindBuffer(...)         GLBindBuffer(GL_CALL_SITE(kGLCallBind), __VA_ARGS__)
+#define glActiveTexture(...)      GLActiveTexture(GL_CALL_SITE(kGLCallBind), __VA_ARGS__)
+#define glBindTexture(...)        GLBindTexture(GL_CALL_SITE(kGLCallBind), __VA_ARGS__)
+#define glBindSampler(...)        GLBindSampler(GL_CALL_SITE(kGLCallBind), __VA_ARGS__)
+#define glBufferData(...)         GLBufferData(GL_CALL_SITE(kGLCallUpload), __VA_ARGS__)
+#define glBufferSubData(...)      GLBufferSubData(GL_CALL_SITE(kGLCallUpload), __VA_ARGS__)
+#define glTexImage2D(...)         GLTexImage2D(GL_CALL_SITE(kGLCallUpload), __VA_ARGS__)
+#define glEnable(...)             GLEnable(GL_CALL_SITE(kGLCallState), __VA_ARGS__)
+#define glDisable(...)            GLDisable(GL_CALL_SITE(kGLCallState), __VA_ARGS__)
+#define glBlendFunc(...)          GLBlendFunc(GL_CALL_SITE(kGLCallState), __VA_ARGS__)
+#define glDepthFunc(...)          GLDepthFunc(GL_CALL_SITE(kGLCallState), __VA_ARGS__)
+#define glCullFace(...)           GLCullFace(GL_CALL_SITE(kGLCallState), __VA_ARGS__)
+#define glFrontFace(...)          GLFrontFace(GL_CALL_SITE(kGLCallState), __VA_ARGS__)
+#define glPolygonMode(...)        GLPolygonMode(GL_CALL_SITE(kGLCallState), __VA_ARGS__)
+#define glLinkProgram(...)        GLLinkProgram(__VA_ARGS__)
+#define glDeleteProgram(...)      GLDeleteProgram(__VA_ARGS__)
+#define glDeleteBuffers(...)      GLDeleteBuffers(__VA_ARGS__)
+#define glDeleteVertexArrays(...) GLDeleteVertexArrays(__VA_ARGS__)
+#define glDeleteTextures(...)     GLDeleteTextures(__VA_ARGS__)
+
+#endif // GLINSTRUMENT_HPP
@@ -0,0 +1,158 @@
+#ifndef GLSTATE_HPP
+#define GLSTATE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+// Estados de valor único guardados por GLStateCache
+enum GLCachedState {
+  kGLCacheProgram,       // glUseProgram
+  kGLCacheVertexArray,   // glBindVertexArray
+  kGLCacheActiveTexture, // glActiveTexture, como índice da unidade
+  kGLCacheBlend,         // glEnable/glDisable(GL_BLEND)
+  kGLCacheDepthTest,     // glEnable/glDisable(GL_DEPTH_TEST)
+  kGLCacheCullFace,      // glEnable/glDisable(GL_CULL_FACE)
+  kGLCacheBlendFunc,
+  kGLCacheDepthFunc,
+  kGLCacheCullMode,      // glCullFace
+  kGLCacheFrontFace,
+  kGLCachePolygonMode,
+  kGLCachedStateCount
+};
+
+// Unidades de textura acompanhadas; binds nas outras sempre vão para o GL
+const uint32_t kGLCacheTextureUnits = 16;
+
+// Maior uniform guardado (uma mat4); os maiores sempre vão para o GL
+const size_t kGLCacheMaxUniformBytes = 64;
+
+// Cópia do estado OpenGL que o programa definiu, para pular as chamadas que
+// não mudariam nada. Cada set*() devolve true se o valor mudou (e a chamada
+// deve ir para o GL) ou false se ele já estava assim, e nesse caso conta uma
+// chamada evitada. Este arquivo não depende do OpenGL: as funções do glad são
+// substituídas em "glinstrument.hpp", que consulta o cache antes de chamá-las.
+//
+// Os uniforms são guardados por programa, porque o GL os guarda assim; um
+// glLinkProgram() ou glDeleteProgram() descarta os valores do programa.
+// Todo estado começa desconhecido, então a primeira chamada de cada um
+// sempre vai para o GL.
+class GLStateCache {
+  public:
+  GLStateCache() {
+    invalidate();
+  }
+
+  // Esquece tudo, para depois de código que muda o estado sem passar pelo
+  // cache
+  void invalidate() {
+    for (int i = 0; i < kGLCachedStateCount; i++)
+      known[i] = false;
+    for (uint32_t unit = 0; unit < kGLCacheTextureUnits; unit++)
+      textureKnown[unit] = false;
+    uniforms.clear();
+    currentUniforms = NULL;
+  }
+
+  bool set(GLCachedState state, uint64_t value) {
+    if (known[state] && values[state] == value)
+      return skip();
+    known[state]  = true;
+    values[state] = value;
+    if (state == kGLCacheProgram)
+      currentUniforms = &uniforms[value];
+    return true;
+  }
+
+  // Valor atual de um estado, ou 0 se ele é desconhecido
+  uint64_t get(GLCachedState state) const {
+    return known[state] ? values[state] : 0;
+  }
+
+  // Textura 2D da unidade ativa
+  bool setTexture(uint32_t texture) {
+    uint64_t unit = values[kGLCacheActiveTexture];
+    if (!known[kGLCacheActiveTexture] || unit >= kGLCacheTextureUnits)
+      return true;
+    if (textureKnown[unit] && textures[unit] == texture)
+      return skip();
+    textureKnown[unit] = true;
+    textures[unit]     = texture;
+    return true;
+  }
+
+  // Uniform do programa atual. Posições negativas (uniforms que não existem
+  // ou que o compilador removeu) são ignoradas pelo GL, então nunca mudam nada.
+  bool setUniform(int32_t location, const void* data, size_t bytes) {
+    if (location < 0)
+      return skip();
+    if (currentUniforms == NULL || bytes > kGLCacheMaxUniformBytes)
+      return true;
+
+    std::vector<UniformValue>& program = *currentUniforms;
+    if (static_cast<size_t>(location) >= program.size())
+      program.resize(location + 1);
+
+    UniformValue& u = program[location];
+    if (u.bytes == bytes && memcmp(u.data, data, bytes) == 0)
+      return skip();
+    u.bytes = bytes;
+    memcpy(u.data, data, bytes);
+    return true;
+  }
+
+  // O programa foi religado ou apagado: os seus uniforms voltam ao padrão
+  void forgetProgram(uint32_t program) {
+    uniforms.erase(program);
+    if (known[kGLCacheProgram] && values[kGLCacheProgram] == program)
+      currentUniforms = &uniforms[program];
+  }
+
+  // Objetos apagados são desligados pelo GL (o nome volta a ser 0)
+  void forgetVertexArray(uint32_t array) {
+    if (known[kGLCacheVertexArray] && values[kGLCacheVertexArray] == array)
+      values[kGLCacheVertexArray] = 0;
+  }
+
+  void forgetTexture(uint32_t texture) {
+    for (uint32_t unit = 0; unit < kGLCacheTextureUnits; unit++)
+      if (textureKnown[unit] && textures[unit] == texture)
+        textures[unit] = 0;
+  }
+
+  // Fecha o quadro atual
+  void beginFrame() {
+    lastSkipped = skipped;
+    skipped     = 0;
+  }
+
+  // Chamadas evitadas no último quadro fechado
+  size_t getSkipped() const {
+    return lastSkipped;
+  }
+
+  private:
+  struct UniformValue {
+    size_t        bytes = 0; // 0 = ainda não definido
+    unsigned char data[kGLCacheMaxUniformBytes];
+  };
+
+  bool skip() {
+    skipped++;
+    return false;
+  }
+
+  bool     known[kGLCachedStateCount];
+  uint64_t values[kGLCachedStateCount] = {};
+  bool     textureKnown[kGLCacheTextureUnits];
+  uint32_t textures[kGLCacheTextureUnits] = {};
+
+  std::unordered_map<uint64_t, std::vector<UniformValue>> uniforms; // Por programa
+  std::vector<UniformValue>*                              currentUniforms;
+
+  size_t skipped     = 0;
+  size_t lastSkipped = 0;
+};
+
+#endif // GLSTATE_HPP
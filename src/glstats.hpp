@@ -0,0 +1,198 @@
+#ifndef GLSTATS_HPP
+#define GLSTATS_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+// Tipos de chamada OpenGL contados por GLCallStats
+enum GLCallType {
+  kGLCallDraw,    // glDraw*
+  kGLCallUniform, // glUniform*
+  kGLCallBind,    // glUseProgram, glBind*, glActiveTexture
+  kGLCallUpload,  // glBufferData, glBufferSubData, glTexImage2D
+  kGLCallState,   // glEnable, glDisable, glBlendFunc, glDepthFunc
+  kGLCallTypeCount
+};
+
+// Nomes dos tipos no CSV
+const char* const kGLCallTypeNames[kGLCallTypeCount] = {"draw", "uniform", "bind", "upload", "state"};
+
+// Estado guardado para achar binds redundantes (o valor novo é igual ao que
+// já estava) que GLStateCache não acompanha. "slot" separa os estados do
+// mesmo tipo: o alvo de um glBindBuffer ou a unidade de um glBindSampler.
+enum GLStateKind {
+  kGLStateBuffer,
+  kGLStateSampler
+};
+
+// Chamadas de desenho de um mesmo ponto do código em um quadro a partir das
+// quais avisamos (uma vez) em stderr: é o sinal de desenho por triângulo ou
+// por objeto pequeno, que deveria estar agrupado
+const size_t kGLSiteDrawWarning = 2048;
+
+// Contadores das chamadas OpenGL de cada quadro, por tipo e por ponto do
+// código (arquivo e linha), com os bytes enviados e as mudanças de estado
+// redundantes (evitadas ou não por GLStateCache, veja "glstate.hpp"). Este
+// arquivo não depende do OpenGL: as chamadas são contadas pelas macros de
+// "glinstrument.hpp", que substituem as funções do glad.
+//
+// beginFrame() fecha o quadro anterior, cujos números ficam nos "get" abaixo
+// e, se startCsv() foi chamada, vão para o CSV, uma linha por ponto do
+// código ativo no quadro.
+class GLCallStats {
+  public:
+  // Ponto do código que faz chamadas de um tipo
+  struct Site {
+    const char* file;
+    int         line;
+    GLCallType  type;
+    size_t      calls;     // No quadro atual
+    size_t      bytes;
+    size_t      redundant;
+    size_t      lastCalls; // No último quadro fechado
+    bool        warned;
+  };
+
+  ~GLCallStats() {
+    stopCsv();
+  }
+
+  // Registra um ponto do código e devolve o seu índice (as macros guardam o
+  // índice em uma variável estática, então isso acontece uma vez por ponto)
+  size_t addSite(const char* file, int line, GLCallType type) {
+    Site site = {file, line, type, 0, 0, 0, 0, false};
+    sites.push_back(site);
+    return sites.size() - 1;
+  }
+
+  void call(size_t site, size_t bytes = 0, bool redundant = false) {
+    Site& s = sites[site];
+    s.calls++;
+    s.bytes += bytes;
+    s.redundant += redundant ? 1 : 0;
+    current.calls[s.type]++;
+    current.bytes += bytes;
+    current.redundant += redundant ? 1 : 0;
+  }
+
+  // Guarda o valor de um estado e diz se ele já estava assim
+  // (a busca vem antes da inserção para não alocar um nó à toa)
+  bool setState(GLStateKind kind, uint64_t slot, uint64_t value) {
+    auto it = state.find(key(kind, slot));
+    if (it == state.end()) {
+      state[key(kind, slot)] = value;
+      return false;
+    }
+    bool redundant = it->second == value;
+    it->second     = value;
+    return redundant;
+  }
+
+  // Valor atual de um estado, ou 0 se nunca foi definido (o padrão do GL)
+  uint64_t getState(GLStateKind kind, uint64_t slot = 0) const {
+    auto it = state.find(key(kind, slot));
+    return (it != state.end()) ? it->second : 0;
+  }
+
+  // Esquece os estados de um tipo com o valor "value", para objetos apagados
+  // (o GL desfaz as ligações, e o nome pode ser reaproveitado)
+  void forgetValue(GLStateKind kind, uint64_t value) {
+    for (auto it = state.begin(); it != state.end();) {
+      if ((it->first >> 56) == static_cast<uint64_t>(kind) && it->second == value)
+        it = state.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  // Fecha o quadro atual
+  void beginFrame() {
+    if (csv != NULL) {
+      for (const Site& s : sites)
+        if (s.calls > 0)
+          fprintf(csv, "%u,%s,%s:%d,%zu,%zu,%zu\n", frame, kGLCallTypeNames[s.type], s.file, s.line, s.calls, s.bytes,
+                  s.redundant);
+    }
+
+    for (Site& s : sites) {
+      if (s.type == kGLCallDraw && s.calls >= kGLSiteDrawWarning && !s.warned) {
+        fprintf(stderr, "Aviso: %zu chamadas de desenho em um quadro em %s:%d.\n", s.calls, s.file, s.line);
+        s.warned = true;
+      }
+      s.lastCalls = s.calls;
+      s.calls     = 0;
+      s.bytes     = 0;
+      s.redundant = 0;
+    }
+
+    last    = current;
+    current = Totals();
+    frame++;
+  }
+
+  size_t getCalls(GLCallType type) const {
+    return last.calls[type];
+  }
+
+  size_t getBytes() const {
+    return last.bytes;
+  }
+
+  size_t getRedundant() const {
+    return last.redundant;
+  }
+
+  // Ponto do código com mais chamadas do tipo no último quadro, ou NULL
+  const Site* getBusiestSite(GLCallType type) const {
+    const Site* best = NULL;
+    for (const Site& s : sites)
+      if (s.type == type && s.lastCalls > 0 && (best == NULL || s.lastCalls > best->lastCalls))
+        best = &s;
+    return best;
+  }
+
+  // Passa a gravar um CSV com uma linha por (quadro, ponto do código).
+  // Devolve false (e explica em stderr) se não conseguiu criar o arquivo.
+  bool startCsv(const char* path) {
+    stopCsv();
+    csv = fopen(path, "w");
+    if (csv == NULL) {
+      fprintf(stderr, "Não foi possível criar \"%s\".\n", path);
+      return false;
+    }
+    fprintf(csv, "frame,type,site,calls,bytes,redundant\n");
+    return true;
+  }
+
+  void stopCsv() {
+    if (csv != NULL)
+      fclose(csv);
+    csv = NULL;
+  }
+
+  bool isRecordingCsv() const {
+    return csv != NULL;
+  }
+
+  private:
+  struct Totals {
+    size_t calls[kGLCallTypeCount] = {};
+    size_t bytes                   = 0;
+    size_t redundant               = 0;
+  };
+
+  static uint64_t key(GLStateKind kind, uint64_t slot) {
+    return static_cast<uint64_t>(kind) << 56 | (slot & 0x00FFFFFFFFFFFFFFull);
+  }
+
+  std::vector<Site>                      sites;
+  std::unordered_map<uint64_t, uint64_t> state;
+  Totals                                 current;
+  Totals                                 last;
+  uint32_t                               frame = 0;
+  FILE*                                  csv   = NULL;
+};
+
+#endif // GLSTATS_HPP
@@ -0,0 +1,480 @@
+#ifndef HPA_HPP
+#define HPA_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include "maze.hpp"
+
+// Distância local (dentro de um cluster) entre células sem caminho
+const uint16_t kHPAUnreachable = UINT16_MAX;
+
+// Nós expandidos por consulta antes de devolver um caminho parcial; cerca de
+// 1 ms com clusters de 16x16
+const size_t kHPAMaxExpansions = 1024;
+
+// Caminho de um agente calculado por MazeHPA. Guarda o caminho abstrato
+// (células de entrada dos clusters) e só o trecho até o próximo ponto já
+// refinado em células.
+struct MazeHPAPath {
+  vector<uint32_t> waypoints;             // Do início ao objetivo
+  size_t           next     = 0;          // Próximo waypoint a alcançar
+  vector<uint32_t> cells;                 // Trecho refinado, em ordem inversa
+  uint32_t         position = UINT32_MAX; // Célula onde o agente deve estar
+  uint32_t         goal     = UINT32_MAX;
+  bool             partial  = false; // Termina antes do objetivo
+  unsigned int     revision = 0;     // Versão do grafo usada no cálculo
+};
+
+// Busca hierárquica de caminhos (HPA*, Botea et al. 2004) para labirintos
+// grandes, com ou sem passagens extras. O labirinto é dividido em clusters
+// de clusterSize x clusterSize células. As células de cada cluster com
+// passagem para outro cluster são os nós do grafo abstrato, ligados entre
+// clusters pela passagem (custo 1) e, dentro de cada cluster, pelas
+// distâncias pré-calculadas com busca em largura restrita ao cluster.
+//
+// Uma consulta liga o início e o objetivo aos nós dos seus clusters, roda A*
+// no grafo abstrato (heurística de Manhattan) e só refina em células o
+// trecho até o próximo nó, quando o agente chega lá. Quando uma parede muda,
+// onWallChanged() refaz apenas os clusters das duas células afetadas.
+class MazeHPA {
+  public:
+  void build(const MazeGenerator& maze, int clusterSize = 16) {
+    this->maze        = &maze;
+    this->clusterSize = max(2, min(clusterSize, 255)); // Distâncias locais em 16 bits
+    clusterSize       = this->clusterSize;
+    nodeCapacity      = 4 * clusterSize; // Células na borda de um cluster
+    width             = maze.getWidth();
+    height            = maze.getHeight();
+    clustersX         = (width + clusterSize - 1) / clusterSize;
+    clustersY         = (height + clusterSize - 1) / clusterSize;
+
+    clusters.assign(static_cast<size_t>(clustersX) * clustersY, Cluster());
+    cellNode.assign(static_cast<size_t>(width) * height, -1);
+    for (int cy = 0; cy < clustersY; cy++) {
+      for (int cx = 0; cx < clustersX; cx++) {
+        Cluster& cluster = clusters[cy * clustersX + cx];
+        cluster.x0       = cx * clusterSize;
+        cluster.y0       = cy * clusterSize;
+        cluster.x1       = min(cluster.x0 + clusterSize, width);
+        cluster.y1       = min(cluster.y0 + clusterSize, height);
+      }
+    }
+
+    for (size_t c = 0; c < clusters.size(); c++)
+      rebuildCluster(clusters[c]);
+
+    revision++;
+    mazeRevision = maze.getRevision();
+  }
+
+  // Deve ser chamada depois de MazeGenerator::setWall(x, y, dir, ...)
+  void onWallChanged(int x, int y, int dir) {
+    const int dx[4] = {0, 0, 1, -1};
+    const int dy[4] = {-1, 1, 0, 0};
+
+    Cluster& first = clusters[clusterOf(y * width + x)];
+    rebuildCluster(first);
+
+    int nx = x + dx[dir];
+    int ny = y + dy[dir];
+    if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
+      Cluster& second = clusters[clusterOf(ny * width + nx)];
+      if (&second != &first)
+        rebuildCluster(second);
+    }
+
+    revision++;
+    mazeRevision = maze->getRevision();
+  }
+
+  // Calcula o caminho abstrato de (ax, ay) até (bx, by). Retorna false se
+  // não há caminho. Se a busca passa de maxExpansions nós, o caminho vai só
+  // até o nó mais próximo do objetivo já alcançado (path.partial) e a busca
+  // continua de lá quando o agente chegar, o que limita o custo por quadro.
+  bool findPath(int ax, int ay, int bx, int by, MazeHPAPath& path, size_t maxExpansions = kHPAMaxExpansions) {
+    checkRevision();
+
+    const uint32_t a = ay * width + ax;
+    const uint32_t b = by * width + bx;
+
+    path.waypoints.clear();
+    path.cells.clear();
+    path.next     = 1;
+    path.position = a;
+    path.goal     = b;
+    path.partial  = false;
+    path.revision = revision;
+
+    const int      startIndex   = clusterOf(a);
+    const int      goalIndex    = clusterOf(b);
+    const Cluster& startCluster = clusters[startIndex];
+    const Cluster& goalCluster  = clusters[goalIndex];
+
+    // Distâncias do início aos nós do seu cluster (e direto ao objetivo, se
+    // estão no mesmo cluster), e dos nós do cluster do objetivo até ele
+    search(startCluster, a);
+    startDistances.clear();
+    for (uint32_t node : startCluster.nodes)
+      startDistances.push_back(searchDistances[localIndex(startCluster, node)]);
+    const uint16_t direct = (startIndex == goalIndex) ? searchDistances[localIndex(startCluster, b)] : kHPAUnreachable;
+
+    search(goalCluster, b);
+    goalDistances.clear();
+    for (uint32_t node : goalCluster.nodes)
+      goalDistances.push_back(searchDistances[localIndex(goalCluster, node)]);
+
+    // A* sobre o grafo abstrato. Os nós são identificados por
+    // cluster * nodeCapacity + índice no cluster; início e objetivo ganham
+    // identificadores próprios depois do último cluster.
+    const uint32_t startId = static_cast<uint32_t>(clusters.size() * nodeCapacity);
+    const uint32_t goalId  = startId + 1;
+    nodeG.resize(goalId + 1);
+    nodeParent.resize(goalId + 1);
+    nodeStamp.resize(goalId + 1, 0);
+    searchStamp += 2; // stamp == searchStamp: aberto; searchStamp + 1: fechado
+    open.clear(); // Mantém a memória da busca anterior
+    expansions = 0;
+
+    auto cellOf = [&](uint32_t id) -> uint32_t {
+      if (id == startId)
+        return a;
+      if (id == goalId)
+        return b;
+      return clusters[id / nodeCapacity].nodes[id % nodeCapacity];
+    };
+
+    auto relax = [&](uint32_t from, uint32_t to, uint32_t cost) {
+      uint32_t g = nodeG[from] + cost;
+      if (nodeStamp[to] == searchStamp + 1 || (nodeStamp[to] == searchStamp && nodeG[to] <= g))
+        return;
+      nodeStamp[to]  = searchStamp;
+      nodeG[to]      = g;
+      nodeParent[to] = from;
+      open.push_back({g + heuristic(cellOf(to), b), to});
+      push_heap(open.begin(), open.end(), OpenOrder());
+    };
+
+    nodeStamp[startId]  = searchStamp;
+    nodeG[startId]      = 0;
+    nodeParent[startId] = startId;
+    open.push_back({heuristic(a, b), startId});
+
+    uint32_t best      = startId; // Nó fechado mais próximo do objetivo
+    uint32_t bestH     = heuristic(a, b);
+    bool     found     = false;
+    bool     truncated = false;
+    while (!open.empty()) {
+      pop_heap(open.begin(), open.end(), OpenOrder());
+      uint32_t u = open.back().second;
+      open.pop_back();
+      if (nodeStamp[u] != searchStamp)
+        continue; // Já fechado
+      nodeStamp[u] = searchStamp + 1;
+
+      if (u == goalId) {
+        found = true;
+        best  = u;
+        break;
+      }
+
+      uint32_t h = heuristic(cellOf(u), b);
+      if (h < bestH) {
+        best  = u;
+        bestH = h;
+      }
+      // O limite só vale depois de algum progresso, senão o agente não sairia
+      // do lugar
+      if (++expansions > maxExpansions && best != startId) {
+        truncated = true;
+        break;
+      }
+
+      if (u == startId) {
+        const uint32_t base = startIndex * nodeCapacity;
+        for (size_t i = 0; i < startDistances.size(); i++)
+          if (startDistances[i] != kHPAUnreachable)
+            relax(u, base + i, startDistances[i]);
+        if (direct != kHPAUnreachable)
+          relax(u, goalId, direct);
+        continue;
+      }
+
+      // Outros nós do mesmo cluster
+      const int      c       = u / nodeCapacity;
+      const int      index   = u % nodeCapacity;
+      const Cluster& cluster = clusters[c];
+      const size_t   n       = cluster.nodes.size();
+      const uint32_t base    = c * nodeCapacity;
+      for (size_t j = 0; j < n; j++) {
+        uint16_t d = cluster.distances[index * n + j];
+        if (d != kHPAUnreachable && static_cast<int>(j) != index)
+          relax(u, base + j, d);
+      }
+
+      // Passagens para outros clusters
+      forEachCrossing(cluster.nodes[index], [&](uint32_t neighbor) {
+        relax(u, clusterOf(neighbor) * nodeCapacity + cellNode[neighbor], 1);
+      });
+
+      // Objetivo, se este é o cluster dele
+      if (c == goalIndex && goalDistances[index] != kHPAUnreachable)
+        relax(u, goalId, goalDistances[index]);
+    }
+
+    if (!found && !truncated)
+      return false;
+
+    path.partial = !found;
+    for (uint32_t v = best; v != startId; v = nodeParent[v])
+      if (path.waypoints.empty() || path.waypoints.back() != cellOf(v))
+        path.waypoints.push_back(cellOf(v));
+    if (path.waypoints.back() != a)
+      path.waypoints.push_back(a);
+    reverse(path.waypoints.begin(), path.waypoints.end());
+    return true;
+  }
+
+  // Próxima célula do caminho do agente em (ax, ay) até (bx, by), calculando
+  // ou corrigindo "path" quando necessário: o grafo mudou, o agente saiu do
+  // caminho, o objetivo mudou de cluster ou o agente chegou ao fim de um
+  // caminho parcial. Se o objetivo só andou dentro do mesmo cluster, apenas o
+  // último trecho é refeito.
+  bool nextStep(MazeHPAPath& path, int ax, int ay, int bx, int by, int& nextX, int& nextY) {
+    checkRevision();
+
+    const uint32_t a = ay * width + ax;
+    const uint32_t b = by * width + bx;
+    if (a == b) {
+      nextX = ax;
+      nextY = ay;
+      return true;
+    }
+
+    bool valid = path.revision == revision && !path.waypoints.empty() && path.position == a &&
+                 path.goal != UINT32_MAX && clusterOf(path.goal) == clusterOf(b);
+    if (valid && path.goal != b) {
+      path.goal = b;
+      if (!path.partial) {
+        path.waypoints.back() = b;
+        if (path.next + 1 >= path.waypoints.size())
+          path.cells.clear();
+      }
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+      if (!valid && !findPath(ax, ay, bx, by, path))
+        return false;
+
+      if (path.cells.empty()) {
+        while (path.next < path.waypoints.size() && path.waypoints[path.next] == a)
+          path.next++;
+        if (path.next == path.waypoints.size() || !refine(a, path.waypoints[path.next], path.cells)) {
+          valid = false;
+          continue;
+        }
+      }
+
+      uint32_t step = path.cells.back();
+      path.cells.pop_back();
+      path.position = step;
+      if (step == path.waypoints[path.next])
+        path.next++;
+
+      nextX = step % width;
+      nextY = step / width;
+      return true;
+    }
+    return false;
+  }
+
+  size_t getNodeCount() const {
+    size_t count = 0;
+    for (const Cluster& cluster : clusters)
+      count += cluster.nodes.size();
+    return count;
+  }
+
+  // Nós expandidos pelo A* da última consulta
+  size_t getLastExpansions() const {
+    return expansions;
+  }
+
+  private:
+  struct Cluster {
+    int              x0, y0, x1, y1;
+    vector<uint32_t> nodes;     // Células com passagem para outro cluster
+    vector<uint16_t> distances; // nodes.size()^2 distâncias dentro do cluster
+  };
+
+  // Fila de prioridade do A*: (g + h, nó), menor primeiro. É um vetor usado
+  // com push_heap/pop_heap (e não uma priority_queue) para que clear() guarde
+  // a memória entre as buscas.
+  using OpenList  = vector<pair<uint32_t, uint32_t>>;
+  using OpenOrder = greater<pair<uint32_t, uint32_t>>;
+
+  int clusterOf(uint32_t cell) const {
+    return (cell / width / clusterSize) * clustersX + (cell % width) / clusterSize;
+  }
+
+  int localIndex(const Cluster& cluster, uint32_t cell) const {
+    return (cell / width - cluster.y0) * (cluster.x1 - cluster.x0) + (cell % width - cluster.x0);
+  }
+
+  uint32_t heuristic(uint32_t a, uint32_t b) const {
+    return abs(static_cast<int>(a % width) - static_cast<int>(b % width)) +
+           abs(static_cast<int>(a / width) - static_cast<int>(b / width));
+  }
+
+  // Chama f(vizinho) para cada passagem da célula para outro cluster
+  template <typename F>
+  void forEachCrossing(uint32_t cell, F f) const {
+    const int dx[4] = {0, 0, 1, -1};
+    const int dy[4] = {-1, 1, 0, 0};
+    const int x     = cell % width;
+    const int y     = cell / width;
+    const int c     = clusterOf(cell);
+
+    for (int dir = 0; dir < 4; dir++) {
+      int nx = x + dx[dir];
+      int ny = y + dy[dir];
+      if (nx < 0 || nx >= width || ny < 0 || ny >= height || maze->hasWall(x, y, dir))
+        continue;
+      uint32_t neighbor = ny * width + nx;
+      if (clusterOf(neighbor) != c)
+        f(neighbor);
+    }
+  }
+
+  // Busca em largura dentro do cluster a partir de "source". Preenche
+  // searchDistances e searchParents (índices locais ao cluster).
+  void search(const Cluster& cluster, uint32_t source) {
+    const int dx[4] = {0, 0, 1, -1};
+    const int dy[4] = {-1, 1, 0, 0};
+    const int w     = cluster.x1 - cluster.x0;
+    const int h     = cluster.y1 - cluster.y0;
+
+    searchDistances.assign(w * h, kHPAUnreachable);
+    searchParents.resize(w * h);
+    searchQueue.clear();
+
+    int start              = localIndex(cluster, source);
+    searchDistances[start] = 0;
+    searchParents[start]   = start;
+    searchQueue.push_back(start);
+
+    for (size_t head = 0; head < searchQueue.size(); head++) {
+      int local = searchQueue[head];
+      int x     = cluster.x0 + local % w;
+      int y     = cluster.y0 + local / w;
+      for (int dir = 0; dir < 4; dir++) {
+        int nx = x + dx[dir];
+        int ny = y + dy[dir];
+        if (nx < cluster.x0 || nx >= cluster.x1 || ny < cluster.y0 || ny >= cluster.y1 || maze->hasWall(x, y, dir))
+          continue;
+
+        int next = (ny - cluster.y0) * w + (nx - cluster.x0);
+        if (searchDistances[next] == kHPAUnreachable) {
+          searchDistances[next] = searchDistances[local] + 1;
+          searchParents[next]   = local;
+          searchQueue.push_back(next);
+        }
+      }
+    }
+  }
+
+  // Recalcula os nós de um cluster e as distâncias entre eles
+  void rebuildCluster(Cluster& cluster) {
+    for (uint32_t node : cluster.nodes)
+      cellNode[node] = -1;
+    cluster.nodes.clear();
+    for (int y = cluster.y0; y < cluster.y1; y++) {
+      for (int x = cluster.x0; x < cluster.x1; x++) {
+        if (y != cluster.y0 && y != cluster.y1 - 1 && x != cluster.x0 && x != cluster.x1 - 1)
+          continue; // Só as bordas podem ter passagens para fora
+
+        bool crossing = false;
+        forEachCrossing(y * width + x, [&](uint32_t) { crossing = true; });
+        if (crossing) {
+          cellNode[y * width + x] = static_cast<int16_t>(cluster.nodes.size());
+          cluster.nodes.push_back(y * width + x);
+        }
+      }
+    }
+
+    const size_t n = cluster.nodes.size();
+    cluster.distances.assign(n * n, kHPAUnreachable);
+    for (size_t i = 0; i < n; i++) {
+      search(cluster, cluster.nodes[i]);
+      for (size_t j = 0; j < n; j++)
+        cluster.distances[i * n + j] = searchDistances[localIndex(cluster, cluster.nodes[j])];
+    }
+  }
+
+  // Trecho de células de "from" (exclusive) até "to" (inclusive), em ordem
+  // inversa. As duas células são vizinhas por uma passagem ou estão no
+  // mesmo cluster.
+  bool refine(uint32_t from, uint32_t to, vector<uint32_t>& cells) {
+    cells.clear();
+    if (clusterOf(from) != clusterOf(to)) {
+      bool adjacent = false;
+      forEachCrossing(from, [&](uint32_t neighbor) { adjacent |= (neighbor == to); });
+      if (adjacent)
+        cells.push_back(to);
+      return adjacent;
+    }
+
+    // Busca a partir do destino: os pais levam de "from" até ele
+    const Cluster& cluster = clusters[clusterOf(to)];
+    const int      w       = cluster.x1 - cluster.x0;
+    search(cluster, to);
+
+    int local = localIndex(cluster, from);
+    if (searchDistances[local] == kHPAUnreachable)
+      return false;
+
+    while (local != searchParents[local]) {
+      local = searchParents[local];
+      cells.push_back((cluster.y0 + local / w) * width + cluster.x0 + local % w);
+    }
+    reverse(cells.begin(), cells.end());
+    return true;
+  }
+
+  // O labirinto foi alterado sem onWallChanged(): refazemos tudo
+  void checkRevision() {
+    if (maze->getRevision() != mazeRevision) {
+      fprintf(stderr, "Aviso: labirinto alterado sem MazeHPA::onWallChanged(); refazendo o grafo.\n");
+      build(*maze, clusterSize);
+    }
+  }
+
+  const MazeGenerator* maze         = NULL;
+  int                  width        = 0;
+  int                  height       = 0;
+  int                  clusterSize  = 16;
+  int                  nodeCapacity = 64;
+  int                  clustersX    = 0;
+  int                  clustersY    = 0;
+  unsigned int         revision     = 0;
+  unsigned int         mazeRevision = 0;
+  vector<Cluster>      clusters;
+  vector<int16_t>      cellNode; // Índice da célula entre os nós do cluster, ou -1
+
+  // Buffers reaproveitados entre consultas
+  vector<uint16_t> searchDistances;
+  vector<int>      searchParents;
+  vector<int>      searchQueue;
+  vector<uint16_t> startDistances;
+  vector<uint16_t> goalDistances;
+  vector<uint32_t> nodeG;
+  vector<uint32_t> nodeParent;
+  vector<uint32_t> nodeStamp;
+  uint32_t         searchStamp = 0;
+  OpenList         open;
+  size_t           expansions = 0;
+};
+
+#endif // HPA_HPP
@@ -0,0 +1,392 @@
+#ifndef LOD_HPP
+#define LOD_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+#include "mesh.hpp"
+
+// Quádrica de erro (Garland e Heckbert, 1997): soma dos quadrados das
+// distâncias de um ponto aos planos dos triângulos em volta de um vértice,
+// ponderada pela área. Guardamos só os 10 coeficientes distintos da matriz
+// simétrica 4x4.
+struct Quadric {
+  double a00, a01, a02, a03;
+  double a11, a12, a13;
+  double a22, a23;
+  double a33;
+  double weight;
+
+  Quadric()
+      : a00(0), a01(0), a02(0), a03(0), a11(0), a12(0), a13(0), a22(0), a23(0), a33(0), weight(0) {
+  }
+
+  // Quádrica do plano n.p + d = 0 (n unitária) com peso w
+  Quadric(const glm::dvec3& n, double d, double w) {
+    a00    = w * n.x * n.x;
+    a01    = w * n.x * n.y;
+    a02    = w * n.x * n.z;
+    a03    = w * n.x * d;
+    a11    = w * n.y * n.y;
+    a12    = w * n.y * n.z;
+    a13    = w * n.y * d;
+    a22    = w * n.z * n.z;
+    a23    = w * n.z * d;
+    a33    = w * d * d;
+    weight = w;
+  }
+
+  Quadric& operator+=(const Quadric& q) {
+    a00 += q.a00;
+    a01 += q.a01;
+    a02 += q.a02;
+    a03 += q.a03;
+    a11 += q.a11;
+    a12 += q.a12;
+    a13 += q.a13;
+    a22 += q.a22;
+    a23 += q.a23;
+    a33 += q.a33;
+    weight += q.weight;
+    return *this;
+  }
+
+  // Soma ponderada dos quadrados das distâncias de p aos planos
+  double evaluate(const glm::dvec3& p) const {
+    return a00 * p.x * p.x + 2.0 * a01 * p.x * p.y + 2.0 * a02 * p.x * p.z + 2.0 * a03 * p.x +
+           a11 * p.y * p.y + 2.0 * a12 * p.y * p.z + 2.0 * a13 * p.y +
+           a22 * p.z * p.z + 2.0 * a23 * p.z +
+           a33;
+  }
+};
+
+// Simplifica os triângulos "indices" (índices em "vertices") por colapso de
+// arestas guiado por quádricas, até restarem no máximo target_index_count
+// índices ou não haver mais colapsos válidos. Cada colapso move um vértice u
+// para a posição de um vizinho v já existente ("half-edge collapse"), então
+// o resultado usa o mesmo vertex buffer da malha original.
+//
+// "triangle_group" diz a qual grupo (material) cada triângulo pertence, e é
+// atualizado junto com os triângulos de saída. Vértices em bordas abertas,
+// em costuras de textura/normal (mesma posição com atributos diferentes) ou
+// na fronteira entre grupos nunca são movidos, preservando a silhueta e o
+// mapeamento de textura. Retorna o erro do pior colapso aceito, como
+// distância média (em unidades do modelo) aos planos originais.
+float SimplifyMesh(const std::vector<PackedVertex>& vertices, std::vector<uint32_t>& indices,
+                   std::vector<uint32_t>& triangle_group, size_t target_index_count) {
+  const size_t num_vertices = vertices.size();
+
+  std::vector<glm::dvec3> position(num_vertices);
+  for (size_t v = 0; v < num_vertices; v++)
+    position[v] = glm::dvec3(vertices[v].position[0], vertices[v].position[1], vertices[v].position[2]);
+
+  // Vértices travados
+  std::vector<unsigned char> locked(num_vertices, 0);
+
+  // Costuras: mais de um vértice na mesma posição
+  {
+    struct PositionHash {
+      size_t operator()(const glm::vec3& p) const {
+        uint32_t bits[3];
+        memcpy(bits, &p, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+      }
+    };
+
+    std::unordered_map<glm::vec3, uint32_t, PositionHash> first_vertex;
+    for (size_t v = 0; v < num_vertices; v++) {
+      glm::vec3 p(vertices[v].position[0], vertices[v].position[1], vertices[v].position[2]);
+      auto      it = first_vertex.find(p);
+      if (it == first_vertex.end()) {
+        first_vertex[p] = static_cast<uint32_t>(v);
+      } else {
+        locked[v]          = 1;
+        locked[it->second] = 1;
+      }
+    }
+  }
+
+  // Fronteira entre grupos
+  {
+    const uint32_t        none = UINT32_MAX;
+    std::vector<uint32_t> vertex_group(num_vertices, none);
+    for (size_t i = 0; i < indices.size(); i++) {
+      uint32_t v = indices[i];
+      uint32_t g = triangle_group[i / 3];
+      if (vertex_group[v] == none)
+        vertex_group[v] = g;
+      else if (vertex_group[v] != g)
+        locked[v] = 1;
+    }
+  }
+
+  // Bordas abertas: arestas que pertencem a um único triângulo
+  {
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t t = 0; t < indices.size() / 3; t++) {
+      for (int k = 0; k < 3; k++) {
+        uint32_t a = indices[3 * t + k];
+        uint32_t b = indices[3 * t + (k + 1) % 3];
+        edges.push_back((uint64_t(std::min(a, b)) << 32) | std::max(a, b));
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    for (size_t i = 0; i < edges.size();) {
+      size_t j = i;
+      while (j < edges.size() && edges[j] == edges[i])
+        j++;
+      if (j - i == 1) {
+        locked[edges[i] >> 32]        = 1;
+        locked[edges[i] & 0xFFFFFFFF] = 1;
+      }
+      i = j;
+    }
+  }
+
+  // Quádricas iniciais: planos dos triângulos, ponderados pela área
+  std::vector<Quadric> quadric(num_vertices);
+  for (size_t t = 0; t < indices.size() / 3; t++) {
+    const glm::dvec3& p0 = position[indices[3 * t + 0]];
+    const glm::dvec3& p1 = position[indices[3 * t + 1]];
+    const glm::dvec3& p2 = position[indices[3 * t + 2]];
+
+    glm::dvec3 n      = glm::cross(p1 - p0, p2 - p0);
+    double     length = glm::length(n);
+    if (length == 0.0)
+      continue;
+
+    n /= length;
+    Quadric q(n, -glm::dot(n, p0), 0.5 * length);
+    for (int k = 0; k < 3; k++)
+      quadric[indices[3 * t + k]] += q;
+  }
+
+  struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    float    error;
+  };
+
+  std::vector<Collapse>      collapses;
+  std::vector<uint64_t>      edges;
+  std::vector<uint32_t>      adjacency_offsets(num_vertices + 1);
+  std::vector<uint32_t>      adjacency;
+  std::vector<unsigned char> dirty(num_vertices);
+
+  float  max_error     = 0.0f;
+  size_t num_triangles = indices.size() / 3;
+
+  while (num_triangles * 3 > target_index_count) {
+    // Arestas distintas da malha atual
+    edges.clear();
+    for (size_t t = 0; t < num_triangles; t++) {
+      for (int k = 0; k < 3; k++) {
+        uint32_t a = indices[3 * t + k];
+        uint32_t b = indices[3 * t + (k + 1) % 3];
+        edges.push_back((uint64_t(std::min(a, b)) << 32) | std::max(a, b));
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // Para cada aresta, a direção de colapso mais barata
+    collapses.clear();
+    for (uint64_t edge : edges) {
+      uint32_t a = static_cast<uint32_t>(edge >> 32);
+      uint32_t b = static_cast<uint32_t>(edge & 0xFFFFFFFF);
+
+      Quadric q = quadric[a];
+      q += quadric[b];
+      double weight = q.weight > 0.0 ? q.weight : 1.0;
+
+      double cost_ab = locked[a] ? INFINITY : q.evaluate(position[b]) / weight;
+      double cost_ba = locked[b] ? INFINITY : q.evaluate(position[a]) / weight;
+      if (std::isinf(cost_ab) && std::isinf(cost_ba))
+        continue;
+
+      Collapse c;
+      c.from  = cost_ab <= cost_ba ? a : b;
+      c.to    = cost_ab <= cost_ba ? b : a;
+      c.error = static_cast<float>(std::sqrt(std::max(std::min(cost_ab, cost_ba), 0.0)));
+      collapses.push_back(c);
+    }
+
+    std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+      return x.error < y.error;
+    });
+
+    // Adjacência vértice -> triângulos da malha atual
+    std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+    for (size_t i = 0; i < num_triangles * 3; i++)
+      adjacency_offsets[indices[i] + 1]++;
+    for (size_t v = 0; v < num_vertices; v++)
+      adjacency_offsets[v + 1] += adjacency_offsets[v];
+    adjacency.resize(num_triangles * 3);
+    {
+      std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+      for (size_t i = 0; i < num_triangles * 3; i++)
+        adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    // Aplicamos os colapsos mais baratos. Um colapso altera todos os
+    // triângulos em volta de "from"; os vértices desses triângulos ficam
+    // marcados até a próxima passada, para que a adjacência continue válida.
+    std::fill(dirty.begin(), dirty.end(), 0);
+    size_t removed        = 0;
+    size_t removed_target = num_triangles - target_index_count / 3;
+
+    for (const Collapse& c : collapses) {
+      if (removed >= removed_target)
+        break;
+      if (dirty[c.from] || dirty[c.to])
+        continue;
+
+      // Rejeitamos colapsos que invertem algum triângulo
+      bool flips = false;
+      for (uint32_t a = adjacency_offsets[c.from]; a < adjacency_offsets[c.from + 1] && !flips; a++) {
+        const uint32_t* tri = &indices[3 * adjacency[a]];
+        if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+          continue;
+
+        glm::dvec3 p[3], q[3];
+        for (int k = 0; k < 3; k++) {
+          p[k] = position[tri[k]];
+          q[k] = tri[k] == c.from ? position[c.to] : p[k];
+        }
+        glm::dvec3 n0 = glm::cross(p[1] - p[0], p[2] - p[0]);
+        glm::dvec3 n1 = glm::cross(q[1] - q[0], q[2] - q[0]);
+        flips         = glm::dot(n0, n1) <= 0.0;
+      }
+      if (flips)
+        continue;
+
+      for (uint32_t a = adjacency_offsets[c.from]; a < adjacency_offsets[c.from + 1]; a++) {
+        uint32_t* tri = &indices[3 * adjacency[a]];
+        if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+          removed++;
+        for (int k = 0; k < 3; k++) {
+          if (tri[k] == c.from)
+            tri[k] = c.to;
+          dirty[tri[k]] = 1;
+        }
+      }
+
+      dirty[c.from] = 1;
+      quadric[c.to] += quadric[c.from];
+      max_error = std::max(max_error, c.error);
+    }
+
+    if (removed == 0)
+      break;
+
+    // Removemos os triângulos degenerados
+    size_t kept = 0;
+    for (size_t t = 0; t < num_triangles; t++) {
+      uint32_t a = indices[3 * t + 0];
+      uint32_t b = indices[3 * t + 1];
+      uint32_t d = indices[3 * t + 2];
+      if (a == b || b == d || a == d)
+        continue;
+
+      indices[3 * kept + 0]  = a;
+      indices[3 * kept + 1]  = b;
+      indices[3 * kept + 2]  = d;
+      triangle_group[kept++] = triangle_group[t];
+    }
+    num_triangles = kept;
+  }
+
+  indices.resize(num_triangles * 3);
+  triangle_group.resize(num_triangles);
+  return max_error;
+}
+
+// Gera "num_levels" níveis de detalhe para cada shape da malha, cada um com
+// metade dos triângulos do anterior. Os níveis são sempre simplificados a
+// partir da malha original (nível 0), e seus triângulos são acrescentados ao
+// final do index buffer e ordenados para a cache de vértices. Deve ser
+// chamada depois de OptimizeIndexedMesh().
+void GenerateLODs(IndexedMesh& mesh, int num_levels) {
+  for (MeshShape& shape : mesh.shapes) {
+    shape.lods.clear();
+
+    // Triângulos originais do shape e o grupo de cada um
+    std::vector<uint32_t> original;
+    std::vector<uint32_t> original_group;
+    for (size_t g = 0; g < shape.groups.size(); g++) {
+      const MeshGroup& group = shape.groups[g];
+      original.insert(original.end(),
+                      mesh.indices.begin() + group.first_index,
+                      mesh.indices.begin() + group.first_index + group.index_count);
+      original_group.insert(original_group.end(), group.index_count / 3, static_cast<uint32_t>(g));
+    }
+
+    size_t previous_count = original.size();
+    for (int level = 1; level < num_levels; level++) {
+      std::vector<uint32_t> indices        = original;
+      std::vector<uint32_t> triangle_group = original_group;
+
+      size_t target = (original.size() / 3 >> level) * 3;
+      float  error  = SimplifyMesh(mesh.vertices, indices, triangle_group, target);
+
+      // Não vale a pena guardar um nível que quase não simplificou
+      if (indices.size() > previous_count * 9 / 10)
+        break;
+      previous_count = indices.size();
+
+      MeshLevel lod;
+      lod.error = error;
+      for (size_t g = 0; g < shape.groups.size(); g++) {
+        MeshGroup group;
+        group.material_id = shape.groups[g].material_id;
+        group.first_index = mesh.indices.size();
+
+        for (size_t t = 0; t < triangle_group.size(); t++)
+          if (triangle_group[t] == g)
+            mesh.indices.insert(mesh.indices.end(), &indices[3 * t], &indices[3 * t] + 3);
+
+        group.index_count = mesh.indices.size() - group.first_index;
+        if (group.index_count == 0)
+          continue;
+
+        OptimizeVertexCache(mesh.indices.data() + group.first_index, group.index_count, mesh.vertices.size());
+        lod.groups.push_back(group);
+      }
+      shape.lods.push_back(lod);
+    }
+  }
+}
+
+// Escolhe o nível de detalhe a desenhar: o mais simples cujo erro
+// geométrico, projetado na tela, fica abaixo de max_pixel_error pixels.
+// "pixels_per_unit" é quantos pixels uma unidade do espaço do modelo ocupa
+// na distância em que o objeto está (veja ProjectedPixelsPerUnit()).
+// "Level" é qualquer tipo com um campo "error" (ex: MeshLevel).
+template <typename Level>
+int SelectLOD(const std::vector<Level>& lods, float pixels_per_unit, float max_pixel_error) {
+  int level = 0;
+  while (level < static_cast<int>(lods.size()) && lods[level].error * pixels_per_unit <= max_pixel_error)
+    level++;
+  return level;
+}
+
+// Tamanho em pixels, na tela, de um segmento de comprimento 1 (em
+// coordenadas globais) posicionado em "center", para uma janela com
+// "screen_height" pixels de altura. Funciona com projeção perspectiva e
+// ortográfica, já que usa o "w" do ponto em clip space.
+float ProjectedPixelsPerUnit(const glm::mat4& projection, const glm::mat4& view_projection,
+                             const glm::vec3& center, float screen_height) {
+  float w = (view_projection * glm::vec4(center, 1.0f)).w;
+  w       = std::max(w, 1e-3f);
+  return std::fabs(projection[1][1]) * 0.5f * screen_height / w;
+}
+
+#endif // LOD_HPP
@@ -18,6 +18,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 
 // Headers abaixo são específicos de C++
@@ -56,25 +57,60 @@
 #include "utils.h"
 #include "matrices.h"
 
+#include "arena.hpp"
 #include "camera.hpp"
+#include "chunks.hpp"
 #include "collisions.hpp"
+#include "culling.hpp"
+#include "enemies.hpp"
+#include "glinstrument.hpp"
+#include "hpa.hpp"
+#include "lod.hpp"
 #include "maze.hpp"
+#include "mazefile.hpp"
+#include "mazepaths.hpp"
+#include "mesh.hpp"
+#include "meshlet.hpp"
+#include "profiler.hpp"
+#include "pvs.hpp"
+#include "scheduler.hpp"
 
 #define WIDTH 800
 #define HEIGHT 800
 
+// Grupo de triângulos de um mesmo material: intervalo contíguo do index
+// buffer, desenhado com uma única chamada glDrawElements().
 struct FaceGroup {
-  int                 material_id;
-  std::vector<size_t> face_indices;
+  int    material_id;
+  size_t first_index;
+  size_t index_count;
+
+  // Meshlets que cobrem este grupo (veja BuildMeshlets() em "meshlet.hpp").
+  // Só existem no nível de detalhe 0 de malhas grandes.
+  size_t first_meshlet;
+  size_t meshlet_count;
 };
 
-struct SceneObject {
-  std::string            name;
+// Versão simplificada de um objeto, com seus próprios grupos de triângulos
+// (veja GenerateLODs() em "lod.hpp").
+struct LevelOfDetail {
   std::vector<FaceGroup> groups;
+  float                  error; // Erro geométrico, em unidades do modelo
+};
+
+struct SceneObject {
+  std::string                name;
+  std::vector<FaceGroup>     groups;
+  std::vector<LevelOfDetail> lods; // Níveis 1, 2, ...; o nível 0 é "groups"
+  std::vector<Meshlet>       meshlets;
 
   GLenum rendering_mode;
   GLuint vertex_array_object_id;
+  GLenum index_type; // GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT
+  bool   quantized;  // Vértices no formato QuantizedVertex (veja "mesh.hpp")
 
+  // Se "quantized", a bounding box também é usada pelo vertex shader para
+  // decodificar as posições, e não pode ser alterada após a construção.
   glm::vec3 bbox_min;
   glm::vec3 bbox_max;
 
@@ -97,16 +133,21 @@ void PushMatrix(glm::mat4 M);
 void PopMatrix(glm::mat4& M);
 
 // Função para verificar quais paredes estão entre a câmera e o jogador
-std::vector<std::string> GetWallsBetweenCameraAndPlayer();
+void GetWallsBetweenCameraAndPlayer(std::vector<const SceneObject*>& walls);
 std::vector<std::string> GetWallsInCameraFOV();
 
 // Declaração de várias funções utilizadas em main().  Essas estão definidas
 // logo após a definição de main() neste arquivo.
-void   BuildTrianglesAndAddToVirtualScene(ObjModel*);                        // Constrói representação de um ObjModel como malha de triângulos para renderização
+void   BuildTrianglesAndAddToVirtualScene(ObjModel*, IndexedMesh* = NULL, bool quantize = false, int num_lods = 1); // Constrói representação de um ObjModel como malha de triângulos para renderização
+void   PrintMeshInfo(const char* name, const IndexedMesh& mesh);             // Imprime vértices, bytes na GPU e ACMR de uma malha, antes e depois das otimizações
 void   ComputeNormals(ObjModel* model);                                      // Computa normais de um ObjModel, caso não existam.
 void   LoadShadersFromFiles();                                               // Carrega os shaders de vértice e fragmento, criando um programa de GPU
 void   LoadTextureImage(const char* filename);                               // Função que carrega imagens de textura
-void   DrawVirtualObject(const char* object_name);                           // Desenha um objeto armazenado em g_VirtualScene
+void   DrawVirtualObject(const char* object_name, int lod = 0, const MeshletCullInfo* cull = NULL); // Desenha um objeto armazenado em g_VirtualScene
+void   DrawVirtualObject(const SceneObject& obj, int lod = 0, const MeshletCullInfo* cull = NULL);      // Idem, sem procurar o nome no mapa
+void   UploadMazeChunk(MazeChunk& chunk);                                    // Envia a geometria de um chunk do mundo para a GPU
+void   ReleaseMazeChunk(MazeChunk& chunk);                                   // Libera os buffers de um chunk na GPU
+void   DrawMazeChunk(const MazeChunk& chunk);                                // Desenha as paredes de um chunk
 GLuint LoadShader_Vertex(const char* filename);                              // Carrega um vertex shader
 GLuint LoadShader_Fragment(const char* filename);                            // Carrega um fragment shader
 void   LoadShader(const char* filename, GLuint shader_id);                   // Função utilizada pelas duas acima
@@ -119,6 +160,7 @@ void  TextRendering_Init();
 float TextRendering_LineHeight(GLFWwindow* window);
 float TextRendering_CharWidth(GLFWwindow* window);
 void  TextRendering_PrintString(GLFWwindow* window, const std::string& str, float x, float y, float scale = 1.0f);
+void  TextRendering_PrintString(GLFWwindow* window, const char* str, float x, float y, float scale = 1.0f);
 void  TextRendering_PrintMatrix(GLFWwindow* window, glm::mat4 M, float x, float y, float scale = 1.0f);
 void  TextRendering_PrintVector(GLFWwindow* window, glm::vec4 v, float x, float y, float scale = 1.0f);
 void  TextRendering_PrintMatrixVectorProduct(GLFWwindow* window, glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f);
@@ -131,6 +173,7 @@ void TextRendering_ShowModelViewProjection(GLFWwindow* window, glm::mat4 project
 void TextRendering_ShowEulerAngles(GLFWwindow* window);
 void TextRendering_ShowProjection(GLFWwindow* window);
 void TextRendering_ShowFramesPerSecond(GLFWwindow* window);
+void TextRendering_ShowProfiler(GLFWwindow* window);
 
 // Funções callback para comunicação com o sistema operacional e interação do
 // usuário. Veja mais comentários nas definições das mesmas, abaixo.
@@ -175,6 +218,13 @@ std::stack<glm::mat4> g_MatrixStack;
 // Razão de proporção da janela (largura/altura). Veja função FramebufferSizeCallback().
 float g_ScreenRatio = 1.0f;
 
+// Altura da janela em pixels, usada na escolha do nível de detalhe dos objetos
+float g_ScreenHeight = 600.0f;
+
+// Meshlets testados e desenhados no quadro atual. Veja DrawVirtualObject().
+size_t g_MeshletsTested = 0;
+size_t g_MeshletsDrawn  = 0;
+
 // Ângulos de Euler que controlam a rotação de um dos cubos da cena virtual
 float g_AngleX = 0.0f;
 float g_AngleY = 0.0f;
@@ -205,9 +255,12 @@ GLuint g_GpuProgramID = 0;
 GLint  g_model_uniform;
 GLint  g_view_uniform;
 GLint  g_projection_uniform;
+GLint  g_view_projection_uniform;
+GLint  g_camera_position_uniform;
 GLint  g_object_id_uniform;
 GLint  g_bbox_min_uniform;
 GLint  g_bbox_max_uniform;
+GLint  g_quantized_uniform;
 
 // Número de texturas carregadas pela função LoadTextureImage()
 GLuint g_NumLoadedTextures = 0;
@@ -262,7 +315,7 @@ GLint g_fog_color_uniform;
 GLint g_fog_density_uniform;
 
 // Armazena as paredes que estão entre a câmera e o jogador
-std::vector<std::string> g_WallsBetweenCameraAndPlayer;
+std::vector<const SceneObject*> g_WallsBetweenCameraAndPlayer;
 
 bool   camTransitionActive      = false;
 float  camTransitionStartTime   = 0.0f;
@@ -283,6 +336,18 @@ return u*u*u*p0
 + t*t*t*p3;
 }
 
+// Far plane padrão das câmeras. Com fog ativo ele é aproximado até a
+// distância de visibilidade do fog (veja o loop de renderização em main()).
+const float g_CameraFarPlane = -1000.0f;
+
+// Erro máximo, em pixels, aceito ao trocar um objeto por um nível de detalhe
+// mais simples (veja SelectLOD() em "lod.hpp").
+const float g_MaxLodPixelError = 1.0f;
+
+// Quadros seguidos sem chunks chegando a partir dos quais o jogo está em
+// regime e os quadros não devem alocar memória (veja ALLOC_CHECK em main())
+const int g_SteadyStateFrames = 120;
+
 // Camera
 SphericCamera sphericCamera(5.0f,
                             g_CameraTheta,
@@ -291,7 +356,7 @@ SphericCamera sphericCamera(5.0f,
                             glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
                             glm::vec4(0.0f, 1.0f, 0.0f, 0.0f),
                             -0.01f,
-                            -1000.0f,
+                            g_CameraFarPlane,
                             3.141592 / 3.0f,
                             (float) WIDTH / HEIGHT,
                             true);
@@ -302,7 +367,7 @@ FreeCamera freeCamera(5.0f,
                       glm::vec4(-10.0f, 0.0f, 0.0f, 1.0f),
                       glm::vec4(0.0f, 1.0f, 0.0f, 0.0f),
                       -0.01f,
-                      -1000.0f,
+                      g_CameraFarPlane,
                       3.141592 / 3.0f,
                       (float) WIDTH / HEIGHT,
                       true);
@@ -311,7 +376,7 @@ FreeCamera transitionalCam(
                         5.0f, 0, 0,
                         glm::vec4(0),      // pos inicial será sobrescrita
                         glm::vec4(0,1,0,0),// up vector
-                        -0.01f, -1000.0f,
+                        -0.01f, g_CameraFarPlane,
                         3.141592f/3.0f,
                         (float)WIDTH/HEIGHT,
                         true
@@ -337,32 +402,44 @@ bool g_PlayerWon = false;
 glm::vec4 g_CowPosition  = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
 float     g_CowRotationY = 0.0f;
 
-// Estrutura para representar um inimigo
-struct Enemy {
-  glm::vec4 position;
-  float     rotationY;
-  int       colorType;  // 0 = vermelho, 1 = azul
-  float     waveOffset; // Para movimento de onda individual
-
-  // Variáveis para movimento
-  int   cellX, cellY;             // Posição atual na grade do labirinto
-  int   targetCellX, targetCellY; // Célula de destino
-  float moveTimer;                // Timer para controlar velocidade de movimento
-  float moveSpeed;                // Velocidade de movimento
-  bool  isMoving;                 // Se está se movendo para uma nova célula
-
-  // Variáveis para perseguição do jogador
-  float detectionRadius; // Raio de detecção do jogador
-  bool  isChasing;       // Se está perseguindo o jogador
-  float chaseSpeed;      // Velocidade quando perseguindo (mais rápida)
+// Inimigos (veja "enemies.hpp")
+EnemySystem g_Enemies;
+
+// Tempo gasto em cada fase do quadro (veja "profiler.hpp"). A tecla B mostra
+// as médias na tela e a tecla T grava os últimos quadros em g_TraceFileName.
+Profiler    g_Profiler;
+GLuint      g_ProfilerQueries[kProfilerMaxGpuQueries];
+bool        g_ShowProfiler  = false;
+const char* g_TraceFileName = "trace.json";
+
+// Cópia do estado OpenGL, que pula as mudanças que não mudam nada, e as
+// chamadas OpenGL de cada quadro, contadas só nas compilações de depuração
+// (veja "glinstrument.hpp"). A tecla G liga e desliga a gravação do CSV.
+GLStateCache g_GLState;
+GLCallStats  g_GLStats;
+const char* g_GLStatsFileName = "glstats.csv";
+
+// Objeto a ser desenhado em um quadro: objeto de g_VirtualScene, matriz de
+// modelagem e identificador do objeto usado pelo fragment shader.
+struct RenderItem {
+  const SceneObject* object;
+  glm::mat4          model;
+  int                object_id;
 };
 
-// Lista de inimigos
-std::vector<Enemy> g_Enemies;
-
 // Gerador de labirinto global
 MazeGenerator* g_Maze = nullptr;
 
+// Caminhos mínimos no labirinto, usados pelos inimigos para perseguir o jogador
+MazeTreePaths g_MazePaths;
+
+// Busca hierárquica usada no lugar de g_MazePaths quando o labirinto tem
+// passagens extras ou foi alterado
+MazeHPA g_MazeHPA;
+
+// Chunks do mundo ao redor do labirinto inicial (veja "chunks.hpp")
+MazeChunkStreamer* g_Chunks = nullptr;
+
 float deltaTime     = 0.0f;
 float lastFrameTime = 0.0f;
 
@@ -473,21 +550,73 @@ int main(int argc, char* argv[]) {
   planeobj->bbox_min    = glm::vec3(planeobj->transform * glm::vec4(planeobj->bbox_min, 1.0f));
   planeobj->bbox_max    = glm::vec3(planeobj->transform * glm::vec4(planeobj->bbox_max, 1.0f));
 
-  ObjModel ghostmodel("../../data/pacman_ghost.obj");
+  IndexedMesh ghostmesh;
+  ObjModel    ghostmodel("../../data/pacman_ghost.obj");
   ComputeNormals(&ghostmodel);
-  BuildTrianglesAndAddToVirtualScene(&ghostmodel);
+  BuildTrianglesAndAddToVirtualScene(&ghostmodel, &ghostmesh, true, 4);
+  PrintMeshInfo("ghost", ghostmesh);
   SceneObject* ghost = &g_VirtualScene["ghost"];
   ghost->transform   = Matrix_Identity() * Matrix_Scale(0.01, 0.01, 0.01);
 
-  ObjModel cowmodel("../../data/cow.obj");
+  IndexedMesh cowmesh;
+  ObjModel    cowmodel("../../data/cow.obj");
   ComputeNormals(&cowmodel);
-  BuildTrianglesAndAddToVirtualScene(&cowmodel);
+  BuildTrianglesAndAddToVirtualScene(&cowmodel, &cowmesh, true, 4);
+  PrintMeshInfo("cow", cowmesh);
   SceneObject* cow = &g_VirtualScene["cow"];
 
-  // Generate the maze
-  MazeGenerator maze(20, 20);
-  maze.generateMaze();
+  // Generate the maze. Ele ocupa o chunk (0, 0) do mundo; os demais chunks
+  // são gerados sob demanda ao redor do jogador.
+  MazeGenerator maze(kChunkCells, kChunkCells);
+
+  // Com a variável de ambiente MAZE_FILE, o labirinto é lido desse arquivo
+  // (veja "mazefile.hpp"), ou gerado e gravado nele se o arquivo ainda não
+  // existe. Assim várias execuções usam exatamente o mesmo labirinto.
+  const char* mazeFileName = getenv("MAZE_FILE");
+  MazeFile    mazeFile;
+  if (mazeFileName != NULL && mazeFile.open(mazeFileName)) {
+    if (mazeFile.getWidth() == kChunkCells && mazeFile.getHeight() == kChunkCells) {
+      mazeFile.loadInto(maze);
+      printf("Labirinto carregado de \"%s\" (semente %u).\n", mazeFileName, mazeFile.getSeed());
+    } else {
+      fprintf(stderr, "Labirinto \"%s\" não tem %dx%d células; gerando outro.\n", mazeFileName, kChunkCells, kChunkCells);
+      maze.generateMaze();
+    }
+    mazeFile.close();
+  } else {
+    maze.generateMaze();
+    if (mazeFileName != NULL && SaveMazeFile(maze, mazeFileName))
+      printf("Labirinto salvo em \"%s\".\n", mazeFileName);
+  }
   g_Maze = &maze; // Armazenar referência global
+  g_MazePaths.build(maze);
+  g_MazeHPA.build(maze);
+
+  // Raio de 2 chunks (5x5 chunks carregados) cobre a distância de
+  // visibilidade do fog e boa parte da vista da câmera superior. Os chunks
+  // usam a semente do labirinto, então um mesmo MAZE_FILE reproduz o mundo todo.
+  std::unique_ptr<MazeChunkStreamer> chunks(new MazeChunkStreamer(maze.getSeed(), 2, 36, UploadMazeChunk, ReleaseMazeChunk));
+  g_Chunks = chunks.get();
+
+  // Trabalho caro que pode esperar alguns quadros é espalhado pelo
+  // escalonador (veja "scheduler.hpp"): no máximo 4 ms por quadro, dos quais
+  // 2 ms para enviar chunks para a GPU e 1 ms para recalcular as paredes entre
+  // a câmera e o jogador. Cada tipo de tarefa tem uma chave, então só o
+  // pedido mais recente fica na fila.
+  FrameScheduler scheduler(4.0);
+  const int      occlusionTasks   = scheduler.addCategory("oclusao", 1.0);
+  const int      chunkTasks       = scheduler.addCategory("chunks", 2.0);
+  const uint64_t kOcclusionTask   = 1;
+  const uint64_t kChunkUploadTask = 2;
+
+  // O recálculo das paredes só é pedido quando a câmera ou o jogador muda de
+  // célula (cubos do tamanho de uma célula do labirinto) ou a cada
+  // kOcclusionRefreshFrames quadros
+  const float    kOcclusionCellSize      = 2.0f;
+  const uint32_t kOcclusionRefreshFrames = 30;
+  glm::ivec3     occlusionCameraCube(0);
+  glm::ivec3     occlusionPlayerCube(0);
+  uint32_t       framesSinceOcclusion = kOcclusionRefreshFrames;
 
   {
     // Usa célula central (10,10) num labirinto 20×20 (cellSize = 2.0)
@@ -510,8 +639,61 @@ int main(int argc, char* argv[]) {
     BuildTrianglesAndAddToVirtualScene(wallModel.get());
   }
 
-  // Guardar nomes das paredes para desenhar depois
-  std::list<std::string> wallNames = maze.getWallNames();
+  // Guardar nomes das paredes para desenhar depois. Usamos um vetor para
+  // acessar as paredes pelo índice, na mesma ordem de getCellWallRange().
+  std::list<std::string>   wallNameList = maze.getWallNames();
+  std::vector<std::string> wallNames(wallNameList.begin(), wallNameList.end());
+
+  // Pré-computamos o conjunto potencialmente visível (PVS) de cada célula.
+  MazePVS mazePVS;
+  mazePVS.build(maze);
+  mazePVS.printInfo();
+
+  // As paredes são desenhadas com uma translação fixa e nunca se movem, então
+  // suas caixas envolventes em coordenadas globais são calculadas uma única vez.
+  glm::mat4          wallModel = Matrix_Translate(0.0f, -1.1f, 0.0f);
+  // Guardamos também o endereço de cada parede no mapa (que não muda), para
+  // não procurar o nome a cada quadro.
+  culling::BoundsSoA              wallBounds;
+  std::vector<const SceneObject*> wallObjects;
+  wallBounds.reserve(wallNames.size());
+  for (const std::string& wallName : wallNames) {
+    const SceneObject& obj = g_VirtualScene[wallName];
+    wallBounds.add(culling::transformAABB(wallModel, obj.bbox_min, obj.bbox_max));
+    wallObjects.push_back(&obj);
+  }
+
+  // Paredes candidatas a desenho: todas, ou só as das células do PVS da
+  // célula da câmera (e da do jogador, com a câmera em terceira pessoa). Só
+  // são reconstruídas quando uma dessas células muda, e já nascem com espaço
+  // para o pior caso.
+  std::vector<int>   candidateWalls;
+  culling::BoundsSoA candidateWallBounds;
+  std::vector<int>   pvsCells;
+  int                candidateCell       = -2; // -1 = todas as paredes, -2 = ainda não construído
+  int                candidatePlayerCell = -1;
+  candidateWalls.reserve(wallNames.size());
+  candidateWallBounds.reserve(wallNames.size());
+  pvsCells.reserve(maze.getWidth() * maze.getHeight());
+
+  // Topo das paredes em coordenadas globais. Acima disso a câmera enxerga por
+  // cima das paredes e o PVS (calculado em 2D) não vale.
+  const float wallTopY = wallBounds.size() > 0 ? wallBounds.centerY[0] + wallBounds.extentY[0] : 0.0f;
+
+  // Buffers reutilizados a cada quadro pelo frustum culling
+  std::vector<unsigned char> wallVisible;
+  culling::BoundsSoA         itemBounds;
+  std::vector<unsigned char> itemVisible;
+  culling::BoundsSoA         chunkBounds;
+  std::vector<unsigned char> chunkVisible;
+
+  // Memória das listas montadas e descartadas a cada quadro (veja
+  // "arena.hpp"). Com ALLOC_CHECK definida, um executável de depuração
+  // confere que os quadros em regime não alocam nada no heap.
+  FrameArena frameArena(1 << 20);
+  const bool checkAllocations     = getenv("ALLOC_CHECK") != NULL;
+  int        steadyFrames         = 0; // Quadros seguidos sem chunks chegando
+  size_t     lastFrameAllocations = 0;
 
   // Inicializar inimigos em posições válidas do labirinto
   srand(time(NULL));
@@ -540,54 +722,64 @@ int main(int argc, char* argv[]) {
   // Criar inimigos nas primeiras 8 posições válidas
   int numEnemies = min(8, (int) validPositions.size());
   for (int i = 0; i < numEnemies; i++) {
-    Enemy enemy;
-
     // Obter posição da célula
-    enemy.cellX = validPositions[i].first;
-    enemy.cellY = validPositions[i].second;
+    int cellX = validPositions[i].first;
+    int cellY = validPositions[i].second;
 
     // Converter para coordenadas do mundo
-    pair<float, float> worldCoords = g_Maze->cellToWorldCoords(enemy.cellX, enemy.cellY);
-
-    enemy.position.x = worldCoords.first;
-    enemy.position.y = 0.0f;
-    enemy.position.z = worldCoords.second;
-    enemy.position.w = 1.0f;
+    pair<float, float> worldCoords = g_Maze->cellToWorldCoords(cellX, cellY);
 
     // Verificar se não está muito perto do jogador (posição inicial)
-    float distanceToPlayer = glm::length(glm::vec3(enemy.position) - glm::vec3(g_PlayerPosition));
+    float distanceToPlayer = glm::length(glm::vec3(worldCoords.first, 0.0f, worldCoords.second) - glm::vec3(g_PlayerPosition));
     if (distanceToPlayer < 3.0f) {
       // Pular esta posição se estiver muito perto do jogador
       continue;
     }
 
-    enemy.rotationY  = (rand() % 360) * 3.14159f / 180.0f;        // Rotação aleatória
-    enemy.colorType  = i % 2;                                     // Alterna entre vermelho (0) e azul (1)
-    enemy.waveOffset = (rand() % 100) / 100.0f * 2.0f * 3.14159f; // Offset aleatório para onda
-
-    // Inicializar variáveis de movimento
-    enemy.targetCellX = enemy.cellX;
-    enemy.targetCellY = enemy.cellY;
-    enemy.moveTimer   = 0.0f;
-    enemy.moveSpeed   = 1.0f + (rand() % 100) / 100.0f; // Velocidade entre 1.0 e 2.0
-    enemy.isMoving    = false;
-
-    // Inicializar variáveis de perseguição
-    enemy.detectionRadius = 5.0f; // Raio de 5 unidades para detectar o jogador
-    enemy.isChasing       = false;
-    enemy.chaseSpeed      = 0.5f; // Velocidade mais rápida quando perseguindo
+    float rotationY  = (rand() % 360) * 3.14159f / 180.0f;        // Rotação aleatória
+    int   colorType  = i % 2;                                     // Alterna entre vermelho (0) e azul (1)
+    float waveOffset = (rand() % 100) / 100.0f * 2.0f * 3.14159f; // Offset aleatório para onda
+    float moveSpeed  = 1.0f + (rand() % 100) / 100.0f;            // Velocidade entre 1.0 e 2.0
 
-    g_Enemies.push_back(enemy);
+    // Raio de 5 unidades para detectar o jogador; passos mais rápidos quando perseguindo
+    g_Enemies.add(*g_Maze, cellX, cellY, colorType, rotationY, waveOffset, moveSpeed, 0.5f, 5.0f, rand());
   }
 
+  // Modelo extra passado na linha de comando, desenhado na origem. Modelos
+  // grandes são divididos em meshlets (veja "meshlet.hpp").
+  std::vector<std::string> propNames;
   if (argc > 1) {
-    ObjModel model(argv[1]);
-    BuildTrianglesAndAddToVirtualScene(&model);
+    IndexedMesh propmesh;
+    ObjModel    model(argv[1]);
+    ComputeNormals(&model);
+    BuildTrianglesAndAddToVirtualScene(&model, &propmesh);
+    PrintMeshInfo(argv[1], propmesh);
+
+    for (const MeshShape& shape : propmesh.shapes) {
+      propNames.push_back(shape.name);
+      printf("  \"%s\": %zu meshlets\n", shape.name.c_str(), g_VirtualScene[shape.name].meshlets.size());
+    }
   }
 
   // Inicializamos o código para renderização de texto.
   TextRendering_Init();
 
+  // Consultas GL_TIME_ELAPSED para o tempo de cada fase na GPU. O resultado
+  // só é pedido quando já está disponível, então a CPU nunca espera a GPU.
+  glGenQueries(kProfilerMaxGpuQueries, g_ProfilerQueries);
+  g_Profiler.setGpuTimer([](uint32_t query) { glBeginQuery(GL_TIME_ELAPSED, g_ProfilerQueries[query]); },
+                         [] { glEndQuery(GL_TIME_ELAPSED); },
+                         [](uint32_t query, uint64_t& ns) {
+                           GLint available = 0;
+                           glGetQueryObjectiv(g_ProfilerQueries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+                           if (!available)
+                             return false;
+                           GLuint64 elapsed = 0;
+                           glGetQueryObjectui64v(g_ProfilerQueries[query], GL_QUERY_RESULT, &elapsed);
+                           ns = elapsed;
+                           return true;
+                         });
+
   // Habilitamos o Z-buffer. Veja slides 104-116 do documento Aula_09_Projecoes.pdf.
   glEnable(GL_DEPTH_TEST);
 
@@ -602,49 +794,76 @@ int main(int argc, char* argv[]) {
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+  // Objetos desenhados a cada quadro, procurados uma vez só
+  const SceneObject* planeObject = &g_VirtualScene["the_plane"];
+  const SceneObject* ghostObject = &g_VirtualScene["ghost"];
+  const SceneObject* cowObject   = &g_VirtualScene["cow"];
+
+  std::vector<const SceneObject*> propObjects;
+  for (const std::string& propName : propNames)
+    propObjects.push_back(&g_VirtualScene[propName]);
+
   // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
   while (!glfwWindowShouldClose(window)) {
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    frameArena.reset();
+    size_t frameAllocations = g_HeapAllocations;
+    g_Profiler.beginFrame();
+    g_GLState.beginFrame();
+    g_GLStats.beginFrame();
+
+    PROFILE_BEGIN(g_Profiler, "camera");
     glUseProgram(g_GpuProgramID);
 
     // Definir transparência padrão (opaco)
     glUniform1f(g_transparency_uniform, 1.0f);
 
-    // Calcular view/projection com transição suave
-    glm::mat4 view, projection;
-    float currentTime = glfwGetTime();
+    // Escolhemos a câmera ativa deste quadro: durante a transição usamos a
+    // câmera intermediária que percorre a curva de Bézier.
+    float currentFrameTime = glfwGetTime(); // Time in seconds
     if (camTransitionActive) {
-        float t = (currentTime - camTransitionStartTime) / camTransitionDuration;
-        if (t < 1.0f) {
-            glm::vec3 pos  = bezier3(camP0, camP1, camP2, camP3, t);
-            glm::vec3 look = bezier3(lookP0, lookP1, lookP2, lookP3, t);
-            transitionalCam.setPosition(glm::vec4(pos, 1.0f));
-            transitionalCam.setLookAt(   glm::vec4(look,1.0f));
-            view       = transitionalCam.getMatrixView();
-            projection = transitionalCam.getMatrixProjection();
-        } else {
-            camTransitionActive = false;
-            camera = (camera == &sphericCamera) ? (Camera*)&freeCamera : (Camera*)&sphericCamera;
-            view       = camera->getMatrixView();
-            projection = camera->getMatrixProjection();
-        }
-    } else {
-        view       = camera->getMatrixView();
-        projection = camera->getMatrixProjection();
+      float t = (currentFrameTime - camTransitionStartTime) / camTransitionDuration;
+      if (t < 1.0f) {
+        glm::vec3 pos  = bezier3(camP0, camP1, camP2, camP3, t);
+        glm::vec3 look = bezier3(lookP0, lookP1, lookP2, lookP3, t);
+        transitionalCam.setPosition(glm::vec4(pos, 1.0f));
+        transitionalCam.setLookAt(glm::vec4(look, 1.0f));
+      } else {
+        // fim da transição: troca definitiva
+        camTransitionActive = false;
+        camera              = (camera == &sphericCamera) ? (Camera*) &freeCamera : (Camera*) &sphericCamera;
+      }
     }
+    Camera* activeCamera = camTransitionActive ? (Camera*) &transitionalCam : camera;
+
+    // Desativa o fog quando estamos na câmera superior e mantém a densidade
+    // normal na câmera esférica. Além da distância de visibilidade do fog
+    // nada aparece na imagem, então aproximamos o far plane até ela e
+    // limpamos a tela com a cor do fog.
+    const glm::vec4 fogColor           = glm::vec4(0.9f, 0.9f, 1.0f, 1.0f);
+    float           fogDensity         = (camera == &freeCamera) ? 0.0f : 0.15f;
+    float           fogVisibleDistance = culling::fogVisibilityDistance(fogDensity);
+    activeCamera->setFarPlane(fogDensity > 0.0f ? -fogVisibleDistance : g_CameraFarPlane);
+
+    if (fogDensity > 0.0f)
+      glClearColor(fogColor.r, fogColor.g, fogColor.b, fogColor.a);
+    else
+      glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // As matrizes vêm do cache da câmera; só são recalculadas se a câmera mudou.
+    const glm::mat4& view           = activeCamera->getMatrixView();
+    const glm::mat4& projection     = activeCamera->getMatrixProjection();
+    const glm::mat4& viewProjection = activeCamera->getMatrixViewProjection();
+    glm::vec4        cameraPosition = activeCamera->getPosition();
 
-    glUniformMatrix4fv(g_view_uniform,       1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(g_view_uniform, 1, GL_FALSE, glm::value_ptr(view));
     glUniformMatrix4fv(g_projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniformMatrix4fv(g_view_projection_uniform, 1, GL_FALSE, glm::value_ptr(viewProjection));
+    glUniform4fv(g_camera_position_uniform, 1, glm::value_ptr(cameraPosition));
 
-    glUniform4f(g_fog_color_uniform, 0.9f, 0.9f, 1.0f, 1.0f);
-    if (camera == &freeCamera) {
-        // Desativa o fog quando estamos na câmera superior
-        glUniform1f(g_fog_density_uniform, 0.0f);
-    } else {
-        // Mantém densidade normal de fog na câmera esférica
-        glUniform1f(g_fog_density_uniform, 0.15f);
-    }
+    glUniform4fv(g_fog_color_uniform, 1, glm::value_ptr(fogColor));
+    glUniform1f(g_fog_density_uniform, fogDensity);
+    PROFILE_END(g_Profiler);
 
 #define SPHERE 0
 #define BUNNY 1
@@ -655,225 +874,277 @@ int main(int argc, char* argv[]) {
 #define ENEMY_BLUE 6
 #define COW 7
 
-    float currentFrameTime = glfwGetTime(); // Time in seconds
-    if (camTransitionActive) {
-      float t = (currentFrameTime - camTransitionStartTime) / camTransitionDuration;
-        if (camTransitionActive && t < 1.0f) {
-            glm::vec3 pos  = bezier3(camP0, camP1, camP2, camP3, t);
-            glm::vec3 look = bezier3(lookP0, lookP1, lookP2, lookP3, t);
-        
-            transitionalCam.setPosition(glm::vec4(pos,  1.0f));
-            transitionalCam.setLookAt(   glm::vec4(look, 1.0f));
-        
-            view       = transitionalCam.getMatrixView();
-            projection = transitionalCam.getMatrixProjection();
-        } else if (camTransitionActive) {
-            // fim da transição: troca definitiva
-            camTransitionActive = false;
-            camera = (camera == &sphericCamera)
-                   ? (Camera*)&freeCamera
-                   : (Camera*)&sphericCamera;
-        }
-    } else {
-      view       = camera->getMatrixView();
-      projection = camera->getMatrixProjection();
-    }
     deltaTime              = currentFrameTime - lastFrameTime;
     lastFrameTime          = currentFrameTime;
 
     glm::mat4 model = Matrix_Identity();
 
-    // Desenhamos o plano do chão
-    model = g_VirtualScene["the_plane"].transform;
-    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-    glUniform1i(g_object_id_uniform, PLANE);
-    DrawVirtualObject("the_plane");
-
-    // Desenhar o fantasma na posição do jogador com rotação e movimento de onda
-    float waveOffset = 0.2f * sin(currentFrameTime * 2.0f);
-    model            = Matrix_Translate(g_PlayerPosition.x, g_PlayerPosition.y + waveOffset, g_PlayerPosition.z) *
-            Matrix_Rotate_Y(g_PlayerRotationY) *
-            Matrix_Scale(0.01f, 0.01f, 0.01f);
-
-    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-    glUniform1i(g_object_id_uniform, GHOST);
-    DrawVirtualObject("ghost");
-
-    // Desenhar a vaca com rotação lenta
-    g_CowRotationY += 0.5f * deltaTime; // Rotação lenta
-    model = Matrix_Translate(g_CowPosition.x, g_CowPosition.y, g_CowPosition.z) *
-            Matrix_Rotate_Y(g_CowRotationY);
-
-    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-    glUniform1i(g_object_id_uniform, BUNNY);
-    DrawVirtualObject("cow");
+    // Rotação lenta da vaca
+    g_CowRotationY += 0.5f * deltaTime;
 
     // Verificar colisões entre jogador e inimigos
+    PROFILE_BEGIN(g_Profiler, "colisoes");
     CheckPlayerEnemyCollisions();
 
     // Verificar colisão entre jogador e vaca
     CheckPlayerCowCollision();
+    PROFILE_END(g_Profiler);
+
+    // Pede os chunks que faltam ao redor do jogador e descarta os menos
+    // usados além do orçamento. Os que ficaram prontos vão para a GPU pelo
+    // escalonador, um por chamada.
+    PROFILE_BEGIN(g_Profiler, "chunks");
+    g_Chunks->update(glm::vec3(g_PlayerPosition), 0);
+    if (g_Chunks->getReadyCount() > 0)
+      scheduler.submit(chunkTasks, 0, [] { return g_Chunks->uploadNext(); }, kChunkUploadTask);
+    PROFILE_END(g_Profiler);
+
+    // Atualizar todos os inimigos: perseguem o jogador pelo caminho mínimo
+    // quando ele está dentro do labirinto e do raio de detecção, senão
+    // patrulham ao acaso
+    PROFILE_BEGIN(g_Profiler, "inimigos");
+    g_Enemies.update(deltaTime, currentFrameTime, glm::vec3(g_PlayerPosition), maze, g_MazePaths, g_MazeHPA);
+    PROFILE_END(g_Profiler);
+
+    // Célula da câmera para consulta ao PVS. Fora do labirinto ou acima das
+    // paredes usamos todas as paredes (cameraCell = -1).
+    PROFILE_BEGIN(g_Profiler, "objetos");
+    int cameraCellX, cameraCellY;
+    int cameraCell = -1;
+    if (cameraPosition.y < wallTopY && maze.worldToCell(cameraPosition.x, cameraPosition.z, cameraCellX, cameraCellY))
+      cameraCell = cameraCellY * maze.getWidth() + cameraCellX;
+
+    // A câmera em terceira pessoa costuma ficar atrás de uma parede, que é
+    // desenhada transparente; o que o jogador vê através dela está no PVS da
+    // célula dele, e não no da câmera. Nesse modo usamos a união dos dois.
+    int playerCellX, playerCellY;
+    int playerCell = -1;
+    if (cameraCell >= 0 && camera == &sphericCamera &&
+        maze.worldToCell(g_PlayerPosition.x, g_PlayerPosition.z, playerCellX, playerCellY))
+      playerCell = playerCellY * maze.getWidth() + playerCellX;
+
+    auto isCellVisible = [&](int cell) {
+      return mazePVS.isVisible(cameraCell, cell) || (playerCell >= 0 && mazePVS.isVisible(playerCell, cell));
+    };
+
+    if (cameraCell != candidateCell || playerCell != candidatePlayerCell) {
+      candidateWalls.clear();
+      candidateWallBounds.clear();
+
+      if (cameraCell >= 0) {
+        if (playerCell >= 0)
+          mazePVS.getVisibleCells(cameraCell, playerCell, pvsCells);
+        else
+          mazePVS.getVisibleCells(cameraCell, pvsCells);
+        for (int cell : pvsCells) {
+          int begin, end;
+          maze.getCellWallRange(cell % maze.getWidth(), cell / maze.getWidth(), begin, end);
+          for (int wall = begin; wall < end; wall++)
+            candidateWalls.push_back(wall);
+        }
+      } else {
+        for (int wall = 0; wall < (int) wallNames.size(); wall++)
+          candidateWalls.push_back(wall);
+      }
 
-    // Atualizar e desenhar todos os inimigos
-    for (Enemy& enemy : g_Enemies) {
-      // Verificar se o jogador está dentro do raio de detecção
-      float distanceToPlayer = glm::length(glm::vec3(enemy.position) - glm::vec3(g_PlayerPosition));
-      enemy.isChasing        = (distanceToPlayer <= enemy.detectionRadius);
+      for (int wall : candidateWalls)
+        candidateWallBounds.add(wallBounds, wall);
 
-      // Atualizar movimento do inimigo
-      enemy.moveTimer += deltaTime;
+      candidateCell       = cameraCell;
+      candidatePlayerCell = playerCell;
+    }
 
-      if (enemy.isChasing) {
-        // Modo perseguição: mover diretamente em direção ao jogador
-        if (!enemy.isMoving && enemy.moveTimer >= enemy.chaseSpeed) {
-          // Calcular direção para o jogador
-          glm::vec3 directionToPlayer = glm::normalize(glm::vec3(g_PlayerPosition) - glm::vec3(enemy.position));
+    // Montamos a lista de objetos dinâmicos deste quadro junto com suas
+    // caixas envolventes em coordenadas globais. Depois testamos todas as
+    // caixas contra o frustum de uma só vez e desenhamos só as visíveis.
+    const size_t            maxRenderItems = 3 + g_Enemies.size() + propObjects.size();
+    FrameVector<RenderItem> renderItems((ArenaAllocator<RenderItem>(frameArena)));
+    renderItems.reserve(maxRenderItems);
+    itemBounds.clear();
+    itemBounds.reserve(maxRenderItems);
+
+    auto addRenderItem = [&](const SceneObject* obj, const glm::mat4& M, int object_id) {
+      RenderItem item = {obj, M, object_id};
+      renderItems.push_back(item);
+      itemBounds.add(culling::transformAABB(M, obj->bbox_min, obj->bbox_max));
+    };
+
+    // Plano do chão. Ele acompanha o jogador para cobrir os chunks
+    // carregados, andando em múltiplos do período da textura (2 unidades)
+    // para que ela não deslize.
+    {
+      const SceneObject& plane  = *planeObject;
+      float              planeX = 2.0f * std::floor(g_PlayerPosition.x / 2.0f);
+      float              planeZ = 2.0f * std::floor(g_PlayerPosition.z / 2.0f);
+      glm::mat4          M      = Matrix_Translate(planeX, 0.0f, planeZ) * plane.transform;
+      RenderItem         item   = {planeObject, M, PLANE};
+      renderItems.push_back(item);
+      itemBounds.add(collision::AABB{plane.bbox_min + glm::vec3(planeX, 0.0f, planeZ),
+                                     plane.bbox_max + glm::vec3(planeX, 0.0f, planeZ)});
+    }
 
-          // Encontrar a célula mais próxima na direção do jogador
-          vector<pair<int, int>> neighbors = g_Maze->getValidNeighbors(enemy.cellX, enemy.cellY);
+    // Fantasma na posição do jogador com rotação e movimento de onda
+    float waveOffset = 0.2f * sin(currentFrameTime * 2.0f);
+    addRenderItem(ghostObject,
+                  Matrix_Translate(g_PlayerPosition.x, g_PlayerPosition.y + waveOffset, g_PlayerPosition.z) *
+                      Matrix_Rotate_Y(g_PlayerRotationY) *
+                      Matrix_Scale(0.01f, 0.01f, 0.01f),
+                  GHOST);
+
+    // Vaca
+    addRenderItem(cowObject,
+                  Matrix_Translate(g_CowPosition.x, g_CowPosition.y, g_CowPosition.z) *
+                      Matrix_Rotate_Y(g_CowRotationY),
+                  BUNNY);
+
+    // Inimigos. Com o PVS ativo, descartamos os que estão em células que não
+    // podem ser vistas da célula da câmera (nem da do jogador, em terceira
+    // pessoa). Os que passam são marcados como desenhados, o que mantém a IA
+    // deles em um nível de detalhe maior.
+    for (size_t i = 0; i < g_Enemies.size(); i++) {
+      if (cameraCell >= 0 &&
+          !isCellVisible(g_Enemies.getCellY(i) * maze.getWidth() + g_Enemies.getCellX(i)) &&
+          !isCellVisible(g_Enemies.getTargetCellY(i) * maze.getWidth() + g_Enemies.getTargetCellX(i)))
+        continue;
 
-          if (!neighbors.empty()) {
-            int   bestNeighborIndex = 0;
-            float bestDotProduct    = -2.0f; // Inicializar com valor muito baixo
+      // (x, y com a onda, z, rotação em Y)
+      glm::vec4 transform = g_Enemies.getTransform(i);
+      model               = Matrix_Translate(transform.x, transform.y, transform.z) *
+              Matrix_Rotate_Y(transform.w) *
+              Matrix_Scale(0.01f, 0.01f, 0.01f);
+      g_Enemies.markDrawn(i);
 
-            for (int i = 0; i < neighbors.size(); i++) {
-              // Calcular direção para este vizinho
-              pair<float, float> neighborCoords      = maze.cellToWorldCoords(neighbors[i].first, neighbors[i].second);
-              glm::vec3          directionToNeighbor = glm::normalize(
-                           glm::vec3(neighborCoords.first, 0.0f, neighborCoords.second) - glm::vec3(enemy.position));
+      // Inimigos perseguindo ficam vermelhos (mais agressivos); patrulhando
+      // mantêm sua cor original
+      int enemyObjectId = g_Enemies.isDangerous(i) ? ENEMY_RED : ENEMY_BLUE;
+      addRenderItem(ghostObject, model, enemyObjectId);
+    }
 
-              // Calcular produto escalar (quanto mais próximo de 1, melhor a direção)
-              float dotProduct = glm::dot(directionToPlayer, directionToNeighbor);
+    // Modelo passado na linha de comando
+    for (const SceneObject* prop : propObjects)
+      addRenderItem(prop, prop->transform, BUNNY);
 
-              if (dotProduct > bestDotProduct) {
-                bestDotProduct    = dotProduct;
-                bestNeighborIndex = i;
-              }
-            }
+    const collision::Plane* frustumPlanes   = activeCamera->getFrustumPlanes();
+    size_t                  numVisibleItems = culling::cullAABBs(itemBounds, frustumPlanes, itemVisible);
+    if (fogDensity > 0.0f)
+      numVisibleItems = culling::cullAABBsByDistance(itemBounds, glm::vec3(cameraPosition), fogVisibleDistance, itemVisible);
 
-            enemy.targetCellX = neighbors[bestNeighborIndex].first;
-            enemy.targetCellY = neighbors[bestNeighborIndex].second;
-            enemy.isMoving    = true;
-            enemy.moveTimer   = 0.0f;
+    g_MeshletsTested = 0;
+    g_MeshletsDrawn  = 0;
 
-            // Calcular rotação baseada na direção do movimento
-            float deltaX    = enemy.targetCellX - enemy.cellX;
-            float deltaZ    = enemy.targetCellY - enemy.cellY;
-            enemy.rotationY = atan2(deltaX, deltaZ);
-          }
-        }
-      } else {
-        // Modo patrulha: movimento aleatório
-        if (!enemy.isMoving && enemy.moveTimer >= enemy.moveSpeed) {
-          vector<pair<int, int>> neighbors = g_Maze->getValidNeighbors(enemy.cellX, enemy.cellY);
-
-          if (!neighbors.empty()) {
-            // Escolher direção aleatória
-            int randomIndex   = rand() % neighbors.size();
-            enemy.targetCellX = neighbors[randomIndex].first;
-            enemy.targetCellY = neighbors[randomIndex].second;
-            enemy.isMoving    = true;
-            enemy.moveTimer   = 0.0f;
+    for (size_t i = 0; i < renderItems.size(); i++) {
+      if (!itemVisible[i])
+        continue;
 
-            // Calcular rotação baseada na direção do movimento
-            float deltaX    = enemy.targetCellX - enemy.cellX;
-            float deltaZ    = enemy.targetCellY - enemy.cellY;
-            enemy.rotationY = atan2(deltaX, deltaZ);
-          }
-        }
+      // Nível de detalhe a partir do tamanho projetado na tela. O erro de
+      // cada nível está em unidades do modelo, então consideramos também a
+      // maior escala da matriz de modelagem.
+      const SceneObject& obj = *renderItems[i].object;
+      const glm::mat4&   M   = renderItems[i].model;
+      int                lod = 0;
+      if (!obj.lods.empty()) {
+        glm::vec3 center(itemBounds.centerX[i], itemBounds.centerY[i], itemBounds.centerZ[i]);
+        float     pixelsPerUnit = culling::maxScale(M) * ProjectedPixelsPerUnit(projection, viewProjection, center, g_ScreenHeight);
+        lod                     = SelectLOD(obj.lods, pixelsPerUnit, g_MaxLodPixelError);
       }
 
-      // Se está se movendo, interpolar posição
-      if (enemy.isMoving) {
-        float currentSpeed = enemy.isChasing ? enemy.chaseSpeed : enemy.moveSpeed;
-        float moveProgress = enemy.moveTimer / currentSpeed;
-
-        if (moveProgress >= 1.0f) {
-          // Movimento completo
-          enemy.cellX     = enemy.targetCellX;
-          enemy.cellY     = enemy.targetCellY;
-          enemy.isMoving  = false;
-          enemy.moveTimer = 0.0f;
-
-          // Atualizar posição final
-          pair<float, float> worldCoords = g_Maze->cellToWorldCoords(enemy.cellX, enemy.cellY);
-          enemy.position.x               = worldCoords.first;
-          enemy.position.z               = worldCoords.second;
-        } else {
-          // Interpolar posição entre célula atual e destino
-          pair<float, float> currentCoords = g_Maze->cellToWorldCoords(enemy.cellX, enemy.cellY);
-          pair<float, float> targetCoords  = g_Maze->cellToWorldCoords(enemy.targetCellX, enemy.targetCellY);
-
-          enemy.position.x = currentCoords.first + (targetCoords.first - currentCoords.first) * moveProgress;
-          enemy.position.z = currentCoords.second + (targetCoords.second - currentCoords.second) * moveProgress;
-        }
-      }
+      // Objetos grandes divididos em meshlets desenham só os visíveis
+      MeshletCullInfo cull = {M, frustumPlanes, glm::vec3(cameraPosition)};
 
-      // Desenhar inimigo
-      float enemyWaveOffset = 0.2f * sin(currentFrameTime * 2.0f + enemy.waveOffset);
-      model                 = Matrix_Translate(enemy.position.x, enemy.position.y + enemyWaveOffset, enemy.position.z) *
-              Matrix_Rotate_Y(enemy.rotationY) *
-              Matrix_Scale(0.01f, 0.01f, 0.01f);
+      glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(M));
+      glUniform1i(g_object_id_uniform, renderItems[i].object_id);
+      DrawVirtualObject(obj, lod, &cull);
+    }
+    PROFILE_END(g_Profiler);
 
-      glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
+    // Primeiro, desenhar todas as paredes opacas visíveis
+    PROFILE_BEGIN(g_Profiler, "paredes opacas");
+    size_t numVisibleWalls = culling::cullAABBs(candidateWallBounds, frustumPlanes, wallVisible);
+    if (fogDensity > 0.0f)
+      numVisibleWalls = culling::cullAABBsByDistance(candidateWallBounds, glm::vec3(cameraPosition), fogVisibleDistance, wallVisible);
 
-      // Definir cor do inimigo baseado no tipo e estado
-      if (enemy.isChasing) {
-        // Inimigos perseguindo ficam vermelhos (mais agressivos)
-        glUniform1i(g_object_id_uniform, ENEMY_RED);
-      } else {
-        // Inimigos patrulhando mantêm sua cor original
-        if (enemy.colorType == 0) {
-          glUniform1i(g_object_id_uniform, ENEMY_RED);
-        } else {
-          glUniform1i(g_object_id_uniform, ENEMY_BLUE);
-        }
-      }
+    // Todas as paredes usam os mesmos uniforms, definidos uma vez
+    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(wallModel));
+    glUniform1i(g_object_id_uniform, MAZE);
+    glUniform1f(g_transparency_uniform, 1.0f);
+    for (size_t i = 0; i < candidateWalls.size(); i++) {
+      if (!wallVisible[i])
+        continue;
 
-      DrawVirtualObject("ghost");
-    }
+      const SceneObject* wall = wallObjects[candidateWalls[i]];
 
-    // Primeiro, desenhar todas as paredes opacas
-    for (const std::string& wallName : wallNames) {
       // Verificar se esta parede está entre a câmera e o jogador
       bool isWallBetween = std::find(g_WallsBetweenCameraAndPlayer.begin(),
                                      g_WallsBetweenCameraAndPlayer.end(),
-                                     wallName) != g_WallsBetweenCameraAndPlayer.end();
+                                     wall) != g_WallsBetweenCameraAndPlayer.end();
 
       // Renderizar apenas paredes opacas nesta passada
-      if (!isWallBetween) {
-        model = Matrix_Identity() * Matrix_Translate(0.0f, -1.1f, 0.0f);
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, MAZE);
-        glUniform1f(g_transparency_uniform, 1.0f);
-        DrawVirtualObject(wallName.c_str());
-      }
+      if (!isWallBetween)
+        DrawVirtualObject(*wall);
     }
 
+    PROFILE_END(g_Profiler);
+
+    // Chunks do mundo ao redor do labirinto inicial, com o mesmo culling
+    PROFILE_BEGIN(g_Profiler, "desenho chunks");
+    FrameVector<const MazeChunk*> chunkList((ArenaAllocator<const MazeChunk*>(frameArena)));
+    chunkList.reserve(g_Chunks->getResident().size());
+    chunkBounds.clear();
+    chunkBounds.reserve(g_Chunks->getResident().size());
+    for (const MazeChunk& chunk : g_Chunks->getResident()) {
+      chunkBounds.add(chunk.bounds);
+      chunkList.push_back(&chunk);
+    }
 
-    // Atualizar a lista de paredes entre a câmera e o jogador
-    g_WallsBetweenCameraAndPlayer = GetWallsBetweenCameraAndPlayer();
-    // g_WallsBetweenCameraAndPlayer = GetWallsInCameraFOV();
+    size_t numVisibleChunks = culling::cullAABBs(chunkBounds, frustumPlanes, chunkVisible);
+    if (fogDensity > 0.0f)
+      numVisibleChunks = culling::cullAABBsByDistance(chunkBounds, glm::vec3(cameraPosition), fogVisibleDistance, chunkVisible);
+
+    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(Matrix_Identity()));
+    glUniform1i(g_object_id_uniform, MAZE);
+    for (size_t i = 0; i < chunkList.size(); i++)
+      if (chunkVisible[i])
+        DrawMazeChunk(*chunkList[i]);
+    PROFILE_END(g_Profiler);
+
+    // Atualizar a lista de paredes entre a câmera e o jogador. Ela percorre
+    // a cena toda, então fica com o escalonador; até rodar, vale a anterior.
+    PROFILE_BEGIN(g_Profiler, "escalonador");
+    glm::ivec3 cameraCube = glm::ivec3(glm::floor(glm::vec3(camera->getPosition()) / kOcclusionCellSize));
+    glm::ivec3 playerCube = glm::ivec3(glm::floor(glm::vec3(g_PlayerPosition) / kOcclusionCellSize));
+    framesSinceOcclusion++;
+    if (cameraCube != occlusionCameraCube || playerCube != occlusionPlayerCube ||
+        framesSinceOcclusion >= kOcclusionRefreshFrames) {
+      scheduler.submit(occlusionTasks, 0, [] {
+        GetWallsBetweenCameraAndPlayer(g_WallsBetweenCameraAndPlayer);
+        return false;
+      }, kOcclusionTask);
+      occlusionCameraCube  = cameraCube;
+      occlusionPlayerCube  = playerCube;
+      framesSinceOcclusion = 0;
+    }
+    scheduler.run();
+    PROFILE_END(g_Profiler);
 
     // Depois, desenhar todas as paredes transparentes
+    PROFILE_BEGIN(g_Profiler, "paredes transparentes");
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    for (const std::string& wallName : g_WallsBetweenCameraAndPlayer) {
-      if (camera != &sphericCamera)
-        continue;
-
-      model = Matrix_Identity() * Matrix_Translate(0.0f, -1.1f, 0.0f);
-      glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
+    if (camera == &sphericCamera && !g_WallsBetweenCameraAndPlayer.empty()) {
+      glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(wallModel));
       glUniform1i(g_object_id_uniform, MAZE);
       glUniform1f(g_transparency_uniform, 0.5f);
-      DrawVirtualObject(wallName.c_str());
+      for (const SceneObject* wall : g_WallsBetweenCameraAndPlayer)
+        DrawVirtualObject(*wall);
     }
 
     // Restaurar transparência padrão para outros objetos
     glUniform1f(g_transparency_uniform, 1.0f);
+    PROFILE_END(g_Profiler);
 
     // Renderizar informações do jogo (vidas, game over)
+    PROFILE_BEGIN(g_Profiler, "HUD");
     if (g_ShowInfoText) {
       float lineheight = TextRendering_LineHeight(window);
       float charwidth  = TextRendering_CharWidth(window);
@@ -883,6 +1154,63 @@ int main(int argc, char* argv[]) {
       snprintf(livesBuffer, 50, "Vidas: %d", g_PlayerLives);
       TextRendering_PrintString(window, livesBuffer, -1.0f + charwidth, 1.0f - lineheight, 1.0f);
 
+      // Mostrar quantos objetos sobreviveram ao culling. O total conta o
+      // plano, o fantasma do jogador, a vaca, os inimigos, o modelo da linha
+      // de comando, as paredes e os chunks carregados.
+      char cullingBuffer[64];
+      snprintf(cullingBuffer, 64, "Visiveis: %d/%d",
+               (int) (numVisibleItems + numVisibleWalls + numVisibleChunks),
+               (int) (3 + g_Enemies.size() + propNames.size() + wallNames.size() + chunkList.size()));
+      TextRendering_PrintString(window, cullingBuffer, -1.0f + charwidth, 1.0f - 2 * lineheight, 1.0f);
+
+      // Meshlets desenhados dos objetos grandes que passaram no culling
+      if (g_MeshletsTested > 0) {
+        char meshletBuffer[64];
+        snprintf(meshletBuffer, 64, "Meshlets: %d/%d", (int) g_MeshletsDrawn, (int) g_MeshletsTested);
+        TextRendering_PrintString(window, meshletBuffer, -1.0f + charwidth, 1.0f - 3 * lineheight, 1.0f);
+      }
+
+      // Chunks na GPU, memória ocupada por eles e chunks ainda sendo gerados
+      char chunkBuffer[64];
+      snprintf(chunkBuffer, 64, "Chunks: %d (%d KB), %d pendentes", (int) chunkList.size(),
+               (int) (g_Chunks->getGpuBytes() / 1024), (int) g_Chunks->getPendingCount());
+      TextRendering_PrintString(window, chunkBuffer, -1.0f + charwidth, 1.0f - 4 * lineheight, 1.0f);
+
+      // Tarefas adiadas pelo escalonador e as que esperam há muitos quadros
+      char taskBuffer[64];
+      snprintf(taskBuffer, 64, "Tarefas: %d adiadas, %d famintas", (int) scheduler.getDeferredCount(),
+               (int) scheduler.getStarvedCount());
+      TextRendering_PrintString(window, taskBuffer, -1.0f + charwidth, 1.0f - 5 * lineheight, 1.0f);
+
+      // Alocações no heap do quadro anterior e uso da memória temporária
+      char allocBuffer[64];
+      snprintf(allocBuffer, 64, "Heap: %d alocacoes, arena %d KB", (int) lastFrameAllocations,
+               (int) (frameArena.getPeak() / 1024));
+      TextRendering_PrintString(window, allocBuffer, -1.0f + charwidth, 1.0f - 6 * lineheight, 1.0f);
+
+      // Mudanças de estado OpenGL que não mudariam nada, puladas no quadro
+      // anterior
+      char glBuffer[96];
+      snprintf(glBuffer, 96, "Estado GL: %d chamadas evitadas", (int) g_GLState.getSkipped());
+      TextRendering_PrintString(window, glBuffer, -1.0f + charwidth, 1.0f - 7 * lineheight, 1.0f);
+
+      // Chamadas OpenGL do quadro anterior e o ponto do código que mais desenha
+      if (kGLInstrumented) {
+        snprintf(glBuffer, 96, "GL: %d draws, %d uniforms, %d binds, %d KB, %d redundantes",
+                 (int) g_GLStats.getCalls(kGLCallDraw), (int) g_GLStats.getCalls(kGLCallUniform),
+                 (int) g_GLStats.getCalls(kGLCallBind), (int) (g_GLStats.getBytes() / 1024),
+                 (int) g_GLStats.getRedundant());
+        TextRendering_PrintString(window, glBuffer, -1.0f + charwidth, 1.0f - 8 * lineheight, 1.0f);
+
+        const GLCallStats::Site* busiest = g_GLStats.getBusiestSite(kGLCallDraw);
+        if (busiest != NULL) {
+          const char* file = strrchr(busiest->file, '/');
+          snprintf(glBuffer, 96, "Mais draws: %s:%d (%d)", (file != NULL) ? file + 1 : busiest->file, busiest->line,
+                   (int) busiest->lastCalls);
+          TextRendering_PrintString(window, glBuffer, -1.0f + charwidth, 1.0f - 9 * lineheight, 1.0f);
+        }
+      }
+
       // Mostrar game over se necessário
       if (g_GameOver) {
         TextRendering_PrintString(window, "GAME OVER! Pressione R para reiniciar", -0.5f, 0.0f, 2.0f);
@@ -894,14 +1222,32 @@ int main(int argc, char* argv[]) {
       }
     }
 
+    TextRendering_ShowProfiler(window);
+    PROFILE_END(g_Profiler);
+
+    PROFILE_BEGIN(g_Profiler, "swap");
     glfwSwapBuffers(window);
+    PROFILE_END(g_Profiler);
 
     processCursor(g_LastCursorPosX, g_LastCursorPosY);
     processKeys(currentFrameTime);
 
+    // Em regime (sem chunks chegando há alguns quadros) um quadro não deve
+    // alocar nada no heap. Os eventos da janela ficam de fora da conta.
+    lastFrameAllocations = g_HeapAllocations - frameAllocations;
+    steadyFrames         = (g_Chunks->getPendingCount() == 0) ? steadyFrames + 1 : 0;
+    if (checkAllocations && steadyFrames > g_SteadyStateFrames && lastFrameAllocations > 0) {
+      fprintf(stderr, "Quadro em regime alocou %d vezes no heap.\n", (int) lastFrameAllocations);
+      assert(lastFrameAllocations == 0);
+    }
+
     glfwPollEvents();
   }
 
+  // Os chunks liberam seus buffers na GPU, então precisam do contexto OpenGL
+  g_Chunks = nullptr;
+  chunks.reset();
+
   // Finalizamos o uso dos recursos do sistema operacional
   glfwTerminate();
 
@@ -959,8 +1305,8 @@ std::vector<std::string> GetWallsInCameraFOV() {
 
 
 // Função para verificar quais paredes estão entre a câmera e o jogador
-std::vector<std::string> GetWallsBetweenCameraAndPlayer() {
-  std::vector<std::string> wallsBetween;
+void GetWallsBetweenCameraAndPlayer(std::vector<const SceneObject*>& wallsBetween) {
+  wallsBetween.clear();
 
   // Obter o FOV da câmera (assumindo que está em radianos)
   float fov = 3.141592f / 3.0f; // Campo de visão da câmera
@@ -986,11 +1332,9 @@ std::vector<std::string> GetWallsBetweenCameraAndPlayer() {
 
     // Se está no FOV, entre a câmera e o jogador, e o raio intersecta a parede
     if (collision::testAABBLine(objAABB, ray)) {
-      wallsBetween.push_back(name);
+      wallsBetween.push_back(&obj);
     }
   }
-
-  return wallsBetween;
 }
 
 // Função para verificar colisão entre jogador e inimigos
@@ -1003,31 +1347,31 @@ void CheckPlayerEnemyCollisions() {
   playerSphere.center = glm::vec3(g_PlayerPosition.x, g_PlayerPosition.y, g_PlayerPosition.z);
   playerSphere.radius = 0.4f; // Raio um pouco maior para detecção
 
-  // Verificar colisão com cada inimigo
-  for (const Enemy& enemy : g_Enemies) {
+  // Verificar colisão com os inimigos próximos, encontrados pelo hash espacial
+  const float enemyRadius = 0.3f;
+  bool        hit         = false;
+  g_Enemies.forEachNear(playerSphere.center, playerSphere.radius + enemyRadius, [&](uint32_t i, float) {
     // Criar esfera do inimigo
     collision::Sphere enemySphere;
-    enemySphere.center = glm::vec3(enemy.position.x, enemy.position.y, enemy.position.z);
-    enemySphere.radius = 0.3f;
-
-    // Verificar se há colisão
-    if (collision::testSphereSphere(playerSphere, enemySphere)) {
-      // Verificar se é um inimigo vermelho (perigoso)
-      if (enemy.colorType == 0 || enemy.isChasing) { // Inimigos vermelhos ou perseguindo
-        // Jogador morre
-        g_PlayerLives--;
-        printf("Jogador atingido! Vidas restantes: %d\n", g_PlayerLives);
-
-        if (g_PlayerLives <= 0) {
-          g_GameOver = true;
-          printf("Game Over!\n");
-        } else {
-          // Reset da posição do jogador
-          ResetPlayerPosition();
-        }
-
-        return; // Sair da função após primeira colisão
-      }
+    enemySphere.center = g_Enemies.getPosition(i);
+    enemySphere.radius = enemyRadius;
+
+    // Só inimigos vermelhos ou perseguindo são perigosos
+    if (collision::testSphereSphere(playerSphere, enemySphere) && g_Enemies.isDangerous(i))
+      hit = true;
+  });
+
+  if (hit) {
+    // Jogador morre
+    g_PlayerLives--;
+    printf("Jogador atingido! Vidas restantes: %d\n", g_PlayerLives);
+
+    if (g_PlayerLives <= 0) {
+      g_GameOver = true;
+      printf("Game Over!\n");
+    } else {
+      // Reset da posição do jogador
+      ResetPlayerPosition();
     }
   }
 }
@@ -1087,44 +1431,27 @@ void RespawnEnemies() {
   // Criar inimigos nas primeiras 8 posições válidas
   int numEnemies = min(8, (int) validPositions.size());
   for (int i = 0; i < numEnemies; i++) {
-    Enemy enemy;
-
     // Obter posição da célula
-    enemy.cellX = validPositions[i].first;
-    enemy.cellY = validPositions[i].second;
+    int cellX = validPositions[i].first;
+    int cellY = validPositions[i].second;
 
     // Converter para coordenadas do mundo
-    pair<float, float> worldCoords = g_Maze->cellToWorldCoords(enemy.cellX, enemy.cellY);
-
-    enemy.position.x = worldCoords.first;
-    enemy.position.y = 0.0f;
-    enemy.position.z = worldCoords.second;
-    enemy.position.w = 1.0f;
+    pair<float, float> worldCoords = g_Maze->cellToWorldCoords(cellX, cellY);
 
     // Verificar se não está muito perto do jogador (posição inicial)
-    float distanceToPlayer = glm::length(glm::vec3(enemy.position) - glm::vec3(g_PlayerPosition));
+    float distanceToPlayer = glm::length(glm::vec3(worldCoords.first, 0.0f, worldCoords.second) - glm::vec3(g_PlayerPosition));
     if (distanceToPlayer < 3.0f) {
       // Pular esta posição se estiver muito perto do jogador
       continue;
     }
 
-    enemy.rotationY  = (rand() % 360) * 3.14159f / 180.0f;        // Rotação aleatória
-    enemy.colorType  = i % 2;                                     // Alterna entre vermelho (0) e azul (1)
-    enemy.waveOffset = (rand() % 100) / 100.0f * 2.0f * 3.14159f; // Offset aleatório para onda
+    float rotationY  = (rand() % 360) * 3.14159f / 180.0f;        // Rotação aleatória
+    int   colorType  = i % 2;                                     // Alterna entre vermelho (0) e azul (1)
+    float waveOffset = (rand() % 100) / 100.0f * 2.0f * 3.14159f; // Offset aleatório para onda
+    float moveSpeed  = 1.0f + (rand() % 100) / 100.0f;            // Velocidade entre 1.0 e 2.0
 
-    // Inicializar variáveis de movimento
-    enemy.targetCellX = enemy.cellX;
-    enemy.targetCellY = enemy.cellY;
-    enemy.moveTimer   = 0.0f;
-    enemy.moveSpeed   = 1.0f + (rand() % 100) / 100.0f; // Velocidade entre 1.0 e 2.0
-    enemy.isMoving    = false;
-
-    // Inicializar variáveis de perseguição
-    enemy.detectionRadius = 5.0f; // Raio de 5 unidades para detectar o jogador
-    enemy.isChasing       = false;
-    enemy.chaseSpeed      = 0.5f; // Velocidade mais rápida quando perseguindo
-
-    g_Enemies.push_back(enemy);
+    // Raio de 5 unidades para detectar o jogador; passos mais rápidos quando perseguindo
+    g_Enemies.add(*g_Maze, cellX, cellY, colorType, rotationY, waveOffset, moveSpeed, 0.5f, 5.0f, rand());
   }
 
   printf("Inimigos reposicionados: %d\n", (int) g_Enemies.size());
@@ -1181,9 +1508,17 @@ void LoadTextureImage(const char* filename) {
 }
 
 // Função que desenha um objeto armazenado em g_VirtualScene. Veja definição
-// dos objetos na função BuildTrianglesAndAddToVirtualScene().
-void DrawVirtualObject(const char* object_name) {
-  const SceneObject& obj = g_VirtualScene[object_name];
+// dos objetos na função BuildTrianglesAndAddToVirtualScene(). "lod" escolhe
+// o nível de detalhe (0 = malha original); veja SelectLOD() em "lod.hpp".
+// Se "cull" não é NULL, os grupos divididos em meshlets desenham apenas os
+// meshlets visíveis (veja CullMeshlets() em "meshlet.hpp").
+void DrawVirtualObject(const char* object_name, int lod, const MeshletCullInfo* cull) {
+  DrawVirtualObject(g_VirtualScene[object_name], lod, cull);
+}
+
+void DrawVirtualObject(const SceneObject& obj, int lod, const MeshletCullInfo* cull) {
+  lod = std::min(lod, (int) obj.lods.size());
+  const std::vector<FaceGroup>& groups = (lod > 0) ? obj.lods[lod - 1].groups : obj.groups;
 
   glBindVertexArray(obj.vertex_array_object_id);
 
@@ -1192,9 +1527,15 @@ void DrawVirtualObject(const char* object_name) {
   glm::vec3 bbox_max = obj.bbox_max;
   glUniform4f(g_bbox_min_uniform, bbox_min.x, bbox_min.y, bbox_min.z, 1.0f);
   glUniform4f(g_bbox_max_uniform, bbox_max.x, bbox_max.y, bbox_max.z, 1.0f);
+  glUniform1i(g_quantized_uniform, obj.quantized ? 1 : 0);
+
+  // Reaproveitados entre chamadas, para não alocar memória a cada quadro
+  static std::vector<uint32_t>    visibleMeshlets;
+  static std::vector<GLsizei>     drawCounts;
+  static std::vector<const void*> drawOffsets;
 
   // Draw each material group
-  for (const auto& group : obj.groups) {
+  for (const auto& group : groups) {
     const tinyobj::material_t& material =
         (group.material_id >= 0 && group.material_id < obj.materials.size())
             ? obj.materials[group.material_id]
@@ -1207,13 +1548,109 @@ void DrawVirtualObject(const char* object_name) {
     glUniform1f(g_q_uniform, material.shininess);
 
     // Draw all faces with this material
-    for (size_t face : group.face_indices) {
-      size_t offset = face * 3 * sizeof(GLuint);
-      glDrawElements(obj.rendering_mode, 3, GL_UNSIGNED_INT, (void*) (offset));
+    size_t index_size = (obj.index_type == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+
+    if (cull == NULL || group.meshlet_count == 0) {
+      glDrawElements(obj.rendering_mode, (GLsizei) group.index_count, obj.index_type, (void*) (group.first_index * index_size));
+      continue;
     }
+
+    // Apenas os meshlets visíveis, com uma única chamada. Meshlets
+    // consecutivos são contíguos no index buffer e viram um só intervalo.
+    visibleMeshlets.clear();
+    CullMeshlets(obj.meshlets, group.first_meshlet, group.first_meshlet + group.meshlet_count, *cull, visibleMeshlets);
+
+    g_MeshletsTested += group.meshlet_count;
+    g_MeshletsDrawn += visibleMeshlets.size();
+
+    drawCounts.clear();
+    drawOffsets.clear();
+    size_t rangeEnd = 0;
+    for (uint32_t m : visibleMeshlets) {
+      const Meshlet& meshlet = obj.meshlets[m];
+      if (!drawCounts.empty() && meshlet.first_index == rangeEnd) {
+        drawCounts.back() += (GLsizei) meshlet.index_count;
+      } else {
+        drawCounts.push_back((GLsizei) meshlet.index_count);
+        drawOffsets.push_back((const void*) (meshlet.first_index * index_size));
+      }
+      rangeEnd = meshlet.first_index + meshlet.index_count;
+    }
+
+    if (!drawCounts.empty())
+      glMultiDrawElements(obj.rendering_mode, drawCounts.data(), obj.index_type, drawOffsets.data(), (GLsizei) drawCounts.size());
   }
 
+  // O VAO continua ligado: objetos seguidos com o mesmo VAO não o religam, e
+  // todo código que liga um GL_ELEMENT_ARRAY_BUFFER liga antes o seu VAO
+}
+
+// Envia as paredes de um chunk para a GPU, no mesmo formato de vértice dos
+// objetos de g_VirtualScene (PackedVertex). Chamada por MazeChunkStreamer na
+// thread principal.
+void UploadMazeChunk(MazeChunk& chunk) {
+  GLuint vertex_array_object_id;
+  glGenVertexArrays(1, &vertex_array_object_id);
+  glBindVertexArray(vertex_array_object_id);
+
+  GLuint vertex_buffer_id;
+  glGenBuffers(1, &vertex_buffer_id);
+  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_id);
+  glBufferData(GL_ARRAY_BUFFER, chunk.vertices.size() * sizeof(PackedVertex), chunk.vertices.data(), GL_STATIC_DRAW);
+
+  GLsizei stride = sizeof(PackedVertex);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(PackedVertex, position));
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(PackedVertex, normal));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(PackedVertex, texcoord));
+  glEnableVertexAttribArray(2);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  GLuint index_buffer_id;
+  glGenBuffers(1, &index_buffer_id);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, chunk.indices.size() * sizeof(GLuint), chunk.indices.data(), GL_STATIC_DRAW);
+
   glBindVertexArray(0);
+
+  chunk.vertex_array_object_id = vertex_array_object_id;
+  chunk.vertex_buffer_id       = vertex_buffer_id;
+  chunk.index_buffer_id        = index_buffer_id;
+  chunk.gpu_bytes              = chunk.vertices.size() * sizeof(PackedVertex) + chunk.indices.size() * sizeof(GLuint);
+}
+
+void ReleaseMazeChunk(MazeChunk& chunk) {
+  GLuint vertex_array_object_id = chunk.vertex_array_object_id;
+  GLuint buffers[2]             = {chunk.vertex_buffer_id, chunk.index_buffer_id};
+  glDeleteVertexArrays(1, &vertex_array_object_id);
+  glDeleteBuffers(2, buffers);
+
+  chunk.vertex_array_object_id = 0;
+  chunk.vertex_buffer_id       = 0;
+  chunk.index_buffer_id        = 0;
+  chunk.gpu_bytes              = 0;
+}
+
+// Desenha um chunk com o material das paredes do labirinto. As posições já
+// estão em coordenadas globais, então a matriz de modelagem deve ser a
+// identidade.
+void DrawMazeChunk(const MazeChunk& chunk) {
+  static const float ambient[3]  = {0.2f, 0.2f, 0.2f};
+  static const float diffuse[3]  = {0.8f, 0.8f, 0.8f};
+  static const float specular[3] = {0.1f, 0.1f, 0.1f};
+
+  glBindVertexArray(chunk.vertex_array_object_id);
+
+  glUniform4f(g_bbox_min_uniform, chunk.bounds.min.x, chunk.bounds.min.y, chunk.bounds.min.z, 1.0f);
+  glUniform4f(g_bbox_max_uniform, chunk.bounds.max.x, chunk.bounds.max.y, chunk.bounds.max.z, 1.0f);
+  glUniform1i(g_quantized_uniform, 0);
+  glUniform3fv(g_kd_uniform, 1, diffuse);
+  glUniform3fv(g_ka_uniform, 1, ambient);
+  glUniform3fv(g_ks_uniform, 1, specular);
+  glUniform1f(g_q_uniform, 32.0f);
+
+  glDrawElements(GL_TRIANGLES, (GLsizei) chunk.index_count, GL_UNSIGNED_INT, 0);
 }
 
 // Função que carrega os shaders de vértices e de fragmentos que serão
@@ -1254,9 +1691,12 @@ void LoadShadersFromFiles() {
   g_model_uniform        = glGetUniformLocation(g_GpuProgramID, "model");      // Variável da matriz "model"
   g_view_uniform         = glGetUniformLocation(g_GpuProgramID, "view");       // Variável da matriz "view" em shader_vertex.glsl
   g_projection_uniform   = glGetUniformLocation(g_GpuProgramID, "projection"); // Variável da matriz "projection" em shader_vertex.glsl
+  g_view_projection_uniform = glGetUniformLocation(g_GpuProgramID, "view_projection"); // Produto projection*view, calculado uma vez pela câmera
+  g_camera_position_uniform = glGetUniformLocation(g_GpuProgramID, "camera_position"); // Posição da câmera em coordenadas globais
   g_object_id_uniform    = glGetUniformLocation(g_GpuProgramID, "object_id");  // Variável "object_id" em shader_fragment.glsl
   g_bbox_min_uniform     = glGetUniformLocation(g_GpuProgramID, "bbox_min");
   g_bbox_max_uniform     = glGetUniformLocation(g_GpuProgramID, "bbox_max");
+  g_quantized_uniform    = glGetUniformLocation(g_GpuProgramID, "quantized"); // Vértices comprimidos, decodificados em shader_vertex.glsl
   g_kd_uniform           = glGetUniformLocation(g_GpuProgramID, "kd");
   g_ka_uniform           = glGetUniformLocation(g_GpuProgramID, "ka");
   g_ks_uniform           = glGetUniformLocation(g_GpuProgramID, "ks");
@@ -1352,28 +1792,44 @@ void ComputeNormals(ObjModel* model) {
 }
 
 // Constrói triângulos para futura renderização a partir de um ObjModel.
-void BuildTrianglesAndAddToVirtualScene(ObjModel* model) {
+// Se "out_mesh" não é NULL, a malha indexada construída é copiada para ele.
+// Se "quantize" é true, os vértices são enviados no formato comprimido
+// QuantizedVertex (12 bytes em vez de 32). Se "num_lods" > 1, são gerados
+// também níveis de detalhe simplificados (veja GenerateLODs() em "lod.hpp").
+void BuildTrianglesAndAddToVirtualScene(ObjModel* model, IndexedMesh* out_mesh, bool quantize, int num_lods) {
+  // Soldamos os vértices repetidos e montamos um index buffer de verdade
+  // (veja BuildIndexedMesh() em "mesh.hpp").
+  IndexedMesh mesh;
+  BuildIndexedMesh(*model, mesh);
+
+  // Reordenamos triângulos e vértices para a cache de vértices da GPU
+  // (veja OptimizeIndexedMesh() em "mesh.hpp").
+  OptimizeIndexedMesh(mesh);
+
+  if (num_lods > 1)
+    GenerateLODs(mesh, num_lods);
+
+  GLenum index_type = mesh.useShortIndices() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+  // As posições quantizadas são decodificadas com a bounding box do objeto
+  // desenhado. Como todos os shapes compartilham o mesmo vertex buffer,
+  // só comprimimos modelos com um único shape.
+  mesh.quantized = quantize && mesh.shapes.size() == 1;
+
   GLuint vertex_array_object_id;
   glGenVertexArrays(1, &vertex_array_object_id);
   glBindVertexArray(vertex_array_object_id);
 
-  std::vector<GLuint> indices;
-  std::vector<float>  model_coefficients;
-  std::vector<float>  normal_coefficients;
-  std::vector<float>  texture_coefficients;
-
-  for (size_t shape = 0; shape < model->shapes.size(); ++shape) {
-    auto&  mesh      = model->shapes[shape].mesh;
-    size_t num_faces = mesh.num_face_vertices.size();
-
-    glm::vec3 bbox_min(std::numeric_limits<float>::max());
-    glm::vec3 bbox_max(std::numeric_limits<float>::lowest());
-
+  for (const MeshShape& shape : mesh.shapes) {
     SceneObject theobject;
-    theobject.name                   = model->shapes[shape].name;
+    theobject.name                   = shape.name;
     theobject.rendering_mode         = GL_TRIANGLES;
     theobject.vertex_array_object_id = vertex_array_object_id;
+    theobject.index_type             = index_type;
+    theobject.quantized              = mesh.quantized;
     theobject.transform              = Matrix_Identity();
+    theobject.bbox_min               = shape.bbox_min;
+    theobject.bbox_max               = shape.bbox_max;
 
     if (model->materials.empty()) {
       // OBJ has no .mtl — just empty
@@ -1383,107 +1839,138 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel* model) {
       theobject.default_material = g_DefaultMaterial; // Always safe fallback
     }
 
-    // Grouping faces by material
-    std::map<int, FaceGroup> group_map;
+    for (const MeshGroup& meshgroup : shape.groups) {
+      FaceGroup group;
+      group.material_id = meshgroup.material_id;
+      group.first_index = meshgroup.first_index;
+      group.index_count = meshgroup.index_count;
 
-    for (size_t face = 0; face < num_faces; ++face) {
-      assert(mesh.num_face_vertices[face] == 3);
+      // Grupos grandes são divididos em meshlets, descartados um a um
+      group.first_meshlet = theobject.meshlets.size();
+      if (group.index_count / 3 >= kMeshletMinTriangles)
+        BuildMeshlets(mesh, group.first_index, group.index_count, theobject.meshlets);
+      group.meshlet_count = theobject.meshlets.size() - group.first_meshlet;
 
-      int material_id                    = mesh.material_ids[face];
-      group_map[material_id].material_id = material_id;
-      group_map[material_id].face_indices.push_back(face);
-
-      for (size_t vertex = 0; vertex < 3; ++vertex) {
-        tinyobj::index_t idx = mesh.indices[3 * face + vertex];
-
-        indices.push_back(indices.size());
-
-        const float vx = model->attrib.vertices[3 * idx.vertex_index + 0];
-        const float vy = model->attrib.vertices[3 * idx.vertex_index + 1];
-        const float vz = model->attrib.vertices[3 * idx.vertex_index + 2];
-
-        model_coefficients.push_back(vx);
-        model_coefficients.push_back(vy);
-        model_coefficients.push_back(vz);
-        model_coefficients.push_back(1.0f);
-
-        bbox_min.x = std::min(bbox_min.x, vx);
-        bbox_min.y = std::min(bbox_min.y, vy);
-        bbox_min.z = std::min(bbox_min.z, vz);
-        bbox_max.x = std::max(bbox_max.x, vx);
-        bbox_max.y = std::max(bbox_max.y, vy);
-        bbox_max.z = std::max(bbox_max.z, vz);
-
-        if (idx.normal_index != -1) {
-          const float nx = model->attrib.normals[3 * idx.normal_index + 0];
-          const float ny = model->attrib.normals[3 * idx.normal_index + 1];
-          const float nz = model->attrib.normals[3 * idx.normal_index + 2];
-          normal_coefficients.push_back(nx);
-          normal_coefficients.push_back(ny);
-          normal_coefficients.push_back(nz);
-          normal_coefficients.push_back(0.0f);
-        }
+      theobject.groups.push_back(group);
+    }
 
-        if (idx.texcoord_index != -1) {
-          const float u = model->attrib.texcoords[2 * idx.texcoord_index + 0];
-          const float v = model->attrib.texcoords[2 * idx.texcoord_index + 1];
-          texture_coefficients.push_back(u);
-          texture_coefficients.push_back(v);
-        }
+    for (const MeshLevel& meshlevel : shape.lods) {
+      LevelOfDetail lod;
+      lod.error = meshlevel.error;
+      for (const MeshGroup& meshgroup : meshlevel.groups) {
+        FaceGroup group;
+        group.material_id = meshgroup.material_id;
+        group.first_index = meshgroup.first_index;
+        group.index_count   = meshgroup.index_count;
+        group.first_meshlet = 0;
+        group.meshlet_count = 0;
+        lod.groups.push_back(group);
       }
+      theobject.lods.push_back(lod);
     }
 
-    theobject.bbox_min = bbox_min;
-    theobject.bbox_max = bbox_max;
+    g_VirtualScene[theobject.name] = theobject;
+  }
 
-    for (auto& pair : group_map) {
-      theobject.groups.push_back(pair.second);
+  // BuildMeshlets() reordena os triângulos dos grupos grandes, então o ACMR
+  // final da malha original (antes dos índices dos LODs) muda
+  size_t lod0_index_count = 0;
+  for (const MeshShape& shape : mesh.shapes)
+    for (const MeshGroup& group : shape.groups)
+      lod0_index_count += group.index_count;
+  mesh.acmr_after = ComputeACMR(mesh.indices.data(), lod0_index_count, mesh.vertices.size());
+
+  // Upload vertex data: posição, normal e textura intercalados em um único VBO
+  GLuint VBO_vertices_id;
+  glGenBuffers(1, &VBO_vertices_id);
+  glBindBuffer(GL_ARRAY_BUFFER, VBO_vertices_id);
+
+  if (mesh.quantized) {
+    std::vector<QuantizedVertex> vertices;
+    QuantizeVertices(mesh, mesh.shapes[0].bbox_min, mesh.shapes[0].bbox_max, vertices);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(QuantizedVertex), vertices.data(), GL_STATIC_DRAW);
+
+    GLsizei stride = sizeof(QuantizedVertex);
+    glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*) offsetof(QuantizedVertex, position));
+    glEnableVertexAttribArray(0);
+
+    if (mesh.has_normals) {
+      glVertexAttribPointer(1, 2, GL_BYTE, GL_TRUE, stride, (void*) offsetof(QuantizedVertex, normal));
+      glEnableVertexAttribArray(1);
     }
 
+    if (mesh.has_texcoords) {
+      glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*) offsetof(QuantizedVertex, texcoord));
+      glEnableVertexAttribArray(2);
+    }
+  } else {
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(PackedVertex), mesh.vertices.data(), GL_STATIC_DRAW);
 
-    g_VirtualScene[theobject.name] = theobject;
-  }
-
-  // Upload vertex data
+    GLsizei stride = sizeof(PackedVertex);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(PackedVertex, position));
+    glEnableVertexAttribArray(0);
 
-  GLuint VBO_model_coefficients_id;
-  glGenBuffers(1, &VBO_model_coefficients_id);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO_model_coefficients_id);
-  glBufferData(GL_ARRAY_BUFFER, model_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-  glBufferSubData(GL_ARRAY_BUFFER, 0, model_coefficients.size() * sizeof(float), model_coefficients.data());
-  glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
-  glEnableVertexAttribArray(0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (mesh.has_normals) {
+      glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(PackedVertex, normal));
+      glEnableVertexAttribArray(1);
+    }
 
-  if (!normal_coefficients.empty()) {
-    GLuint VBO_normal_coefficients_id;
-    glGenBuffers(1, &VBO_normal_coefficients_id);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_normal_coefficients_id);
-    glBufferData(GL_ARRAY_BUFFER, normal_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, normal_coefficients.size() * sizeof(float), normal_coefficients.data());
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (mesh.has_texcoords) {
+      glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(PackedVertex, texcoord));
+      glEnableVertexAttribArray(2);
+    }
   }
 
-  if (!texture_coefficients.empty()) {
-    GLuint VBO_texture_coefficients_id;
-    glGenBuffers(1, &VBO_texture_coefficients_id);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_texture_coefficients_id);
-    glBufferData(GL_ARRAY_BUFFER, texture_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, texture_coefficients.size() * sizeof(float), texture_coefficients.data());
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+  // Índices de 16 bits sempre que o número de vértices permite
   GLuint indices_id;
   glGenBuffers(1, &indices_id);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), NULL, GL_STATIC_DRAW);
-  glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(GLuint), indices.data());
+  if (index_type == GL_UNSIGNED_SHORT) {
+    std::vector<GLushort> short_indices(mesh.indices.begin(), mesh.indices.end());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, short_indices.size() * sizeof(GLushort), short_indices.data(), GL_STATIC_DRAW);
+  } else {
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(GLuint), mesh.indices.data(), GL_STATIC_DRAW);
+  }
 
   glBindVertexArray(0);
+
+  if (out_mesh != NULL)
+    *out_mesh = mesh;
+}
+
+// Imprime no terminal o número de vértices e os bytes ocupados na GPU por
+// uma malha, comparando com o formato sem índices (um vértice por canto), e o
+// ACMR antes e depois de OptimizeIndexedMesh().
+void PrintMeshInfo(const char* name, const IndexedMesh& mesh) {
+  printf("Malha \"%s\": %zu vértices (antes %zu), %zu bytes na GPU (antes %zu), índices de %d bits, ACMR %.3f (antes %.3f)\n",
+         name,
+         mesh.vertices.size(),
+         mesh.num_corners,
+         mesh.getGpuBytes(),
+         mesh.getUnweldedGpuBytes(),
+         mesh.useShortIndices() ? 16 : 32,
+         mesh.acmr_after,
+         mesh.acmr_before);
+
+  for (const MeshShape& shape : mesh.shapes) {
+    if (shape.lods.empty())
+      continue;
+
+    size_t num_triangles = 0;
+    for (const MeshGroup& group : shape.groups)
+      num_triangles += group.index_count / 3;
+    printf("  LODs de \"%s\": %zu", shape.name.c_str(), num_triangles);
+
+    for (const MeshLevel& lod : shape.lods) {
+      num_triangles = 0;
+      for (const MeshGroup& group : lod.groups)
+        num_triangles += group.index_count / 3;
+      printf(" -> %zu (erro %.4f)", num_triangles, lod.error);
+    }
+    printf(" triângulos\n");
+  }
 }
 
 // Carrega um Vertex Shader de um arquivo GLSL. Veja definição de LoadShader() abaixo.
@@ -1629,6 +2116,7 @@ GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id) {
 void FramebufferSizeCallback(GLFWwindow* window, int width, int height) {
   glViewport(0, 0, width, height);
   camera->setScreenRatio((float) width / height);
+  g_ScreenHeight = (float) height;
 }
 
 // Função callback chamada sempre que o usuário aperta algum dos botões do mouse
@@ -1711,6 +2199,10 @@ void tryPlayerMove(glm::vec4 movement) {
     }
   }
 
+  // Paredes dos chunks do mundo
+  if (!collision && g_Chunks)
+    collision = g_Chunks->collides(playerSphere);
+
   // Se houve colisão, restaurar posição anterior
   if (collision) {
     g_PlayerPosition = oldPlayerPosition;
@@ -1755,6 +2247,9 @@ void trySphericMove(void (*callback)(float deltaTime)) {
     }
   }
 
+  if (!collision && g_Chunks)
+    collision = g_Chunks->collides(cameraSphere);
+
   // Se houve colisão na câmera esférica, mover para mais perto do centro
   if (collision) {
     // Reduzir a distância em pequenos incrementos até não haver mais colisão
@@ -1785,6 +2280,9 @@ void trySphericMove(void (*callback)(float deltaTime)) {
       }
     }
 
+    if (!stillColliding && g_Chunks)
+      stillColliding = g_Chunks->collides(cameraSphere);
+
     // Se ainda há colisão, restaurar distância original
     if (stillColliding) {
       camera->setDistance(oldDistance);
@@ -1879,6 +2377,9 @@ void tryMove(void (*callback)(float deltaTime)) {
     }
   }
 
+  if (!collision && g_Chunks)
+    collision = g_Chunks->collides(cameraSphere);
+
   // Se houve colisão, restaurar posição anterior
   if (collision) {
     camera->setPosition(oldPosition);
@@ -1992,12 +2493,33 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 
     // Se o usuário apertar a tecla P, utilizamos projeção perspectiva.
     if (key == GLFW_KEY_P && action == GLFW_PRESS) {
-      camera->UsePerspectiveProjection = true;
+      camera->setUsePerspectiveProjection(true);
     }
 
     // Se o usuário apertar a tecla O, utilizamos projeção ortográfica.
     if (key == GLFW_KEY_O && action == GLFW_PRESS) {
-      camera->UsePerspectiveProjection = false;
+      camera->setUsePerspectiveProjection(false);
+    }
+
+    // Tecla B: mostra ou esconde o tempo de cada fase do quadro
+    if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+      g_ShowProfiler = !g_ShowProfiler;
+    }
+
+    // Tecla T: grava os últimos quadros medidos para o chrome://tracing
+    if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+      if (g_Profiler.writeChromeTrace(g_TraceFileName))
+        printf("Trace gravado em \"%s\".\n", g_TraceFileName);
+    }
+
+    // Tecla G: começa ou termina a gravação das chamadas OpenGL por quadro
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+      if (g_GLStats.isRecordingCsv()) {
+        g_GLStats.stopCsv();
+        printf("Chamadas OpenGL gravadas em \"%s\".\n", g_GLStatsFileName);
+      } else if (g_GLStats.startCsv(g_GLStatsFileName)) {
+        printf("Gravando chamadas OpenGL em \"%s\"...\n", g_GLStatsFileName);
+      }
     }
 
     // Se o usuário apertar a tecla H, fazemos um "toggle" do texto informativo mostrado na tela.
@@ -2120,6 +2642,23 @@ void TextRendering_ShowProjection(GLFWwindow* window) {
     TextRendering_PrintString(window, "Orthographic", 1.0f - 13 * charwidth, -1.0f + 2 * lineheight / 10, 1.0f);
 }
 
+// Escrevemos no canto inferior esquerdo da tela o tempo médio de cada fase
+// do quadro na CPU e na GPU (veja "profiler.hpp")
+void TextRendering_ShowProfiler(GLFWwindow* window) {
+  if (!g_ShowProfiler)
+    return;
+
+  float lineheight = TextRendering_LineHeight(window);
+  float charwidth  = TextRendering_CharWidth(window);
+
+  const std::vector<Profiler::ZoneStats>& zones = g_Profiler.getZones();
+  for (size_t i = 0; i < zones.size(); i++) {
+    char buffer[80];
+    snprintf(buffer, 80, "%-22s CPU %6.2f ms  GPU %6.2f ms", zones[i].name, zones[i].cpuMs, zones[i].gpuMs);
+    TextRendering_PrintString(window, buffer, -1.0f + charwidth, -1.0f + (zones.size() - i) * lineheight, 1.0f);
+  }
+}
+
 // Escrevemos na tela o número de quadros renderizados por segundo (frames per
 // second).
 void TextRendering_ShowFramesPerSecond(GLFWwindow* window) {
@@ -1,6 +1,12 @@
 #ifndef MAZE_HPP
 #define MAZE_HPP
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <random>
@@ -8,6 +14,8 @@
 #include <memory>
 #include <list>
 #include <fstream>
+#include <functional>
+#include <thread>
 #include <tiny_obj_loader.h>
 
 
@@ -69,6 +77,14 @@ struct ObjModel {
 };
 
 
+// Algoritmo que gerou um labirinto (gravado nos arquivos de "mazefile.hpp")
+enum MazeAlgorithm : uint32_t {
+  MAZE_NOT_GENERATED = 0,
+  MAZE_BACKTRACKING  = 1, // generateMaze()
+  MAZE_TILED         = 2, // generateMazeTiled()
+  MAZE_ELLER         = 3, // generateMazeEller()
+};
+
 class MazeGenerator {
   private:
   struct Cell {
@@ -86,16 +102,28 @@ class MazeGenerator {
   int                  width, height;
   vector<vector<Cell>> grid;
   list<Wall>           walls;
+  unsigned int         seed;
+  MazeAlgorithm        algorithm = MAZE_NOT_GENERATED;
   mt19937              rng;
   int                  wallCounter = 0;
+  unsigned int         revision    = 0; // Incrementada a cada alteração das paredes
+
+  // Para cada célula (índice y * width + x), as paredes geradas por ela
+  // ocupam o intervalo [cellWallOffsets[i], cellWallOffsets[i + 1]) da lista
+  // "walls" (e, portanto, de getWallNames()).
+  vector<int> cellWallOffsets;
 
   // Direções: Norte, Sul, Leste, Oeste
   const int dx[4] = {0, 0, 1, -1};
   const int dy[4] = {-1, 1, 0, 0};
 
   public:
+  // Bits das paredes de uma célula em uma linha emitida por generateRows():
+  // bit "dir" ligado se há parede na direção dir (0=norte, 1=sul, 2=leste, 3=oeste)
+  using RowSink = function<void(int y, const vector<unsigned char>& walls)>;
+
   MazeGenerator(int w, int h, unsigned int seed = random_device{}())
-      : width(w), height(h), rng(seed) {
+      : width(w), height(h), seed(seed), rng(seed) {
     grid.resize(height, vector<Cell>(width));
     initializeGrid();
   }
@@ -112,6 +140,7 @@ class MazeGenerator {
   void generateMaze() {
     // Algoritmo de geração usando DFS recursivo com backtracking
     vector<pair<int, int>> stack;
+    algorithm = MAZE_BACKTRACKING;
 
     // Começar do centro
     int startX = width / 2;
@@ -160,6 +189,228 @@ class MazeGenerator {
     generateWalls();
   }
 
+  // Geração paralela: o grid é dividido em blocos de tileSize x tileSize
+  // células, e cada bloco recebe sua própria árvore geradora (DFS com
+  // backtracking, como em generateMaze()) em uma thread. Depois os blocos são
+  // ligados por uma árvore geradora sobre o grafo de blocos, abrindo
+  // exatamente uma porta por aresta dessa árvore, o que mantém o labirinto
+  // perfeito (um único caminho entre quaisquer duas células).
+  //
+  // Cada bloco usa um gerador aleatório próprio, derivado da semente do
+  // labirinto e do índice do bloco, então o resultado é o mesmo para
+  // qualquer número de threads.
+  void generateMazeTiled(int tileSize = 32, unsigned int numThreads = thread::hardware_concurrency()) {
+    auto startTime = chrono::steady_clock::now();
+    algorithm      = MAZE_TILED;
+
+    tileSize   = max(tileSize, 1);
+    numThreads = max(numThreads, 1u);
+
+    const int tilesX   = (width + tileSize - 1) / tileSize;
+    const int tilesY   = (height + tileSize - 1) / tileSize;
+    const int numTiles = tilesX * tilesY;
+
+    const unsigned int baseSeed = rng();
+
+    atomic<int> nextTile(0);
+    auto        worker = [&]() {
+      vector<pair<int, int>> stack;
+      for (int tile = nextTile++; tile < numTiles; tile = nextTile++) {
+        int x0 = (tile % tilesX) * tileSize;
+        int y0 = (tile / tilesX) * tileSize;
+        int x1 = min(x0 + tileSize, width);
+        int y1 = min(y0 + tileSize, height);
+
+        seed_seq tileSeed = {baseSeed, static_cast<unsigned int>(tile)};
+        mt19937  tileRng(tileSeed);
+        carveTile(x0, y0, x1, y1, tileRng, stack);
+      }
+    };
+
+    vector<thread> threads;
+    for (unsigned int i = 1; i < numThreads && i < static_cast<unsigned int>(numTiles); i++)
+      threads.emplace_back(worker);
+    worker();
+    for (thread& t : threads)
+      t.join();
+
+    // Árvore geradora sobre o grafo de blocos (DFS com backtracking). Para
+    // cada aresta, uma porta em posição aleatória da fronteira entre os blocos.
+    vector<bool>           tileVisited(numTiles, false);
+    vector<pair<int, int>> stack;
+
+    tileVisited[0] = true;
+    stack.push_back({0, 0});
+
+    while (!stack.empty()) {
+      int tx = stack.back().first;
+      int ty = stack.back().second;
+
+      vector<int> neighbors;
+      for (int dir = 0; dir < 4; dir++) {
+        int nx = tx + dx[dir];
+        int ny = ty + dy[dir];
+        if (nx >= 0 && nx < tilesX && ny >= 0 && ny < tilesY && !tileVisited[ny * tilesX + nx])
+          neighbors.push_back(dir);
+      }
+
+      if (neighbors.empty()) {
+        stack.pop_back();
+        continue;
+      }
+
+      int dir = neighbors[rng() % neighbors.size()];
+      int nx  = tx + dx[dir];
+      int ny  = ty + dy[dir];
+
+      if (dx[dir] != 0) {
+        // Fronteira vertical: porta em uma linha entre y0 e y1
+        int y0 = ty * tileSize;
+        int y1 = min(y0 + tileSize, height);
+        int y  = y0 + static_cast<int>(rng() % (y1 - y0));
+        int x  = dx[dir] > 0 ? (tx + 1) * tileSize - 1 : tx * tileSize;
+        removeWall(x, y, x + dx[dir], y);
+      } else {
+        // Fronteira horizontal: porta em uma coluna entre x0 e x1
+        int x0 = tx * tileSize;
+        int x1 = min(x0 + tileSize, width);
+        int x  = x0 + static_cast<int>(rng() % (x1 - x0));
+        int y  = dy[dir] > 0 ? (ty + 1) * tileSize - 1 : ty * tileSize;
+        removeWall(x, y, x, y + dy[dir]);
+      }
+
+      tileVisited[ny * tilesX + nx] = true;
+      stack.push_back({nx, ny});
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    double cells   = static_cast<double>(width) * height;
+    cout << "Labirinto gerado em " << numTiles << " blocos com " << min(numThreads, static_cast<unsigned int>(numTiles))
+         << " threads: " << seconds * 1000.0 << " ms (" << cells / max(seconds, 1e-9) << " células/s)\n";
+
+    // Criar múltiplas entradas e saídas
+    createMultipleEntrances();
+
+    // Converter grid em paredes 3D
+    generateWalls();
+  }
+
+  // Gera o labirinto linha a linha com o algoritmo de Eller, usando memória
+  // proporcional apenas à largura. Cada linha pronta é entregue a "sink"
+  // (em ordem, de y = 0 até height - 1) e não é mais usada depois disso, o
+  // que permite gerar labirintos de altura arbitrária direto para um arquivo,
+  // para as paredes 3D, etc. O resultado é um labirinto perfeito, com as
+  // mesmas paredes dos dois lados de cada passagem (como em removeWall()).
+  //
+  // Em cada linha, células vizinhas de conjuntos diferentes são unidas ao
+  // acaso (na última linha, sempre), e cada conjunto abre ao menos uma
+  // passagem para a linha de baixo; as demais células começam conjuntos novos.
+  static void generateRows(int width, int height, unsigned int seed, const RowSink& sink) {
+    mt19937 rng(seed);
+
+    vector<int>           label(width, -1);  // Conjunto de cada célula da linha atual
+    vector<int>           parent;            // Union-find sobre os conjuntos da linha
+    vector<bool>          openUp(width, false);
+    vector<bool>          openDown(width);
+    vector<unsigned char> walls(width);
+    vector<int>           count, chosen, remap;
+
+    auto find = [&](int a) {
+      while (parent[a] != a)
+        a = parent[a] = parent[parent[a]];
+      return a;
+    };
+
+    for (int y = 0; y < height; y++) {
+      const bool lastRow = (y == height - 1);
+
+      // Células sem conjunto (que não vieram de cima) ganham um novo
+      int numLabels = 0;
+      for (int x = 0; x < width; x++)
+        numLabels = max(numLabels, label[x] + 1);
+      for (int x = 0; x < width; x++)
+        if (label[x] < 0)
+          label[x] = numLabels++;
+
+      parent.resize(numLabels);
+      for (int i = 0; i < numLabels; i++)
+        parent[i] = i;
+
+      for (int x = 0; x < width; x++)
+        walls[x] = openUp[x] ? 0xE : 0xF; // Sul, leste e oeste; norte se não há passagem
+
+      // Uniões horizontais
+      for (int x = 0; x + 1 < width; x++) {
+        int a = find(label[x]);
+        int b = find(label[x + 1]);
+        if (a == b || (!lastRow && (rng() & 1)))
+          continue;
+
+        parent[b] = a;
+        walls[x] &= ~(1 << 2);     // Leste
+        walls[x + 1] &= ~(1 << 3); // Oeste
+      }
+
+      // Passagens para baixo: ao acaso, e uma garantida por conjunto
+      fill(openDown.begin(), openDown.end(), false);
+      if (!lastRow) {
+        count.assign(numLabels, 0);
+        for (int x = 0; x < width; x++)
+          count[find(label[x])]++;
+
+        // Sorteamos qual membro de cada conjunto terá a passagem garantida
+        chosen.assign(numLabels, -1);
+        for (int i = 0; i < numLabels; i++)
+          if (count[i] > 0)
+            chosen[i] = static_cast<int>(rng() % count[i]);
+
+        for (int x = 0; x < width; x++) {
+          int root = find(label[x]);
+          if (chosen[root]-- == 0 || (rng() & 1)) {
+            openDown[x] = true;
+            walls[x] &= ~(1 << 1); // Sul
+          }
+        }
+      }
+
+      sink(y, walls);
+
+      // Próxima linha: as células com passagem para cima herdam o conjunto,
+      // renumerado para que os rótulos fiquem menores que a largura
+      remap.assign(numLabels, -1);
+      int next = 0;
+      for (int x = 0; x < width; x++) {
+        openUp[x] = openDown[x];
+        if (!openDown[x]) {
+          label[x] = -1;
+          continue;
+        }
+        int root = find(label[x]);
+        if (remap[root] < 0)
+          remap[root] = next++;
+        label[x] = remap[root];
+      }
+    }
+  }
+
+  // Preenche o grid com generateRows() em vez de generateMaze()
+  void generateMazeEller() {
+    algorithm = MAZE_ELLER;
+    generateRows(width, height, rng(), [this](int y, const vector<unsigned char>& rowWalls) {
+      for (int x = 0; x < width; x++) {
+        grid[y][x].visited = true;
+        for (int dir = 0; dir < 4; dir++)
+          grid[y][x].walls[dir] = (rowWalls[x] >> dir) & 1;
+      }
+    });
+
+    // Criar múltiplas entradas e saídas
+    createMultipleEntrances();
+
+    // Converter grid em paredes 3D
+    generateWalls();
+  }
+
   void createMultipleEntrances() {
     int numEntrances = 8 + (rng() % 8); // 8 a 16 entradas
 
@@ -196,7 +447,9 @@ class MazeGenerator {
   }
 
   void generateWalls() {
+    revision++;
     walls.clear();
+    cellWallOffsets.assign(1, 0);
     const float cellSize      = 2.0f;
     const float wallThickness = 0.2f;
     const float wallHeight    = 3.0f;
@@ -257,6 +510,8 @@ class MazeGenerator {
           wall.id     = ++wallCounter;
           walls.push_back(wall);
         }
+
+        cellWallOffsets.push_back(static_cast<int>(walls.size()));
       }
     }
   }
@@ -435,6 +690,143 @@ class MazeGenerator {
     return {worldX, worldZ};
   }
 
+  // Função para converter coordenadas do mundo para a célula que as contém.
+  // Retorna false se o ponto está fora do labirinto.
+  bool worldToCell(float worldX, float worldZ, int& cellX, int& cellY) const {
+    const float cellSize = 2.0f;
+    cellX                = static_cast<int>(floor(worldX / cellSize + 0.5f));
+    cellY                = static_cast<int>(floor(worldZ / cellSize + 0.5f));
+    return isValidCell(cellX, cellY);
+  }
+
+  int getWidth() const {
+    return width;
+  }
+
+  int getHeight() const {
+    return height;
+  }
+
+  unsigned int getSeed() const {
+    return seed;
+  }
+
+  MazeAlgorithm getAlgorithm() const {
+    return algorithm;
+  }
+
+  // Indica se a célula (x, y) tem parede na direção dir (0=norte, 1=sul, 2=leste, 3=oeste)
+  bool hasWall(int x, int y, int dir) const {
+    return grid[y][x].walls[dir];
+  }
+
+  // Número que muda sempre que as paredes do labirinto mudam (geração,
+  // carregamento ou setWall()). Serve para estruturas derivadas, como as de
+  // "mazepaths.hpp", saberem que estão desatualizadas.
+  unsigned int getRevision() const {
+    return revision;
+  }
+
+  // Coloca ou remove, durante o jogo, a parede da célula (x, y) na direção
+  // dir, dos dois lados. As paredes 3D (generateWalls()) não são refeitas.
+  void setWall(int x, int y, int dir, bool present) {
+    grid[y][x].walls[dir] = present;
+
+    int nx = x + dx[dir];
+    int ny = y + dy[dir];
+    if (isValidCell(nx, ny))
+      grid[ny][nx].walls[dir ^ 1] = present; // Norte <-> sul, leste <-> oeste
+
+    revision++;
+  }
+
+  // Indica se o segmento entre os centros das células (ax, ay) e (bx, by)
+  // não cruza nenhuma parede. A grade é percorrida célula a célula (como em
+  // Amanatides e Woo), com aritmética inteira: o passo em x vem antes do
+  // passo em y quando (1 + 2 ix) |dy| < (1 + 2 iy) |dx|. Se o segmento passa
+  // exatamente por um canto, basta uma das duas voltas estar livre. Fora do
+  // labirinto não há paredes, então as células podem estar fora da grade.
+  bool hasLineOfSight(int ax, int ay, int bx, int by) const {
+    const int nx   = abs(bx - ax);
+    const int ny   = abs(by - ay);
+    const int sx   = bx > ax ? 1 : -1;
+    const int sy   = by > ay ? 1 : -1;
+    const int dirX = sx > 0 ? 2 : 3;
+    const int dirY = sy > 0 ? 1 : 0;
+
+    // Parede entre (x, y) e a vizinha na direção dir, vista de qualquer lado
+    auto blocked = [&](int x, int y, int dir) {
+      int ox = x + dx[dir];
+      int oy = y + dy[dir];
+      return (isValidCell(x, y) && grid[y][x].walls[dir]) || (isValidCell(ox, oy) && grid[oy][ox].walls[dir ^ 1]);
+    };
+
+    int x = ax, y = ay;
+    for (int ix = 0, iy = 0; ix < nx || iy < ny;) {
+      long long side = static_cast<long long>(1 + 2 * ix) * ny - static_cast<long long>(1 + 2 * iy) * nx;
+      if (side < 0) {
+        if (blocked(x, y, dirX))
+          return false;
+        x += sx;
+        ix++;
+      } else if (side > 0) {
+        if (blocked(x, y, dirY))
+          return false;
+        y += sy;
+        iy++;
+      } else {
+        bool viaX = !blocked(x, y, dirX) && !blocked(x + sx, y, dirY);
+        bool viaY = !blocked(x, y, dirY) && !blocked(x, y + sy, dirX);
+        if (!viaX && !viaY)
+          return false;
+        x += sx;
+        y += sy;
+        ix++;
+        iy++;
+      }
+    }
+    return true;
+  }
+
+  // Paredes da célula (x, y) em 4 bits, bit "dir" ligado se há parede
+  unsigned char getWallMask(int x, int y) const {
+    const bool* cellWalls = grid[y][x].walls;
+    return static_cast<unsigned char>(cellWalls[0] | cellWalls[1] << 1 | cellWalls[2] << 2 | cellWalls[3] << 3);
+  }
+
+  // Substitui o labirinto por um de w x h células com as paredes dadas por
+  // wallMask(x, y) (bits como em getWallMask()) e recria as paredes 3D. Usada
+  // para carregar labirintos salvos (veja "mazefile.hpp").
+  void assignWalls(int w, int h, unsigned int mazeSeed, MazeAlgorithm mazeAlgorithm,
+                   const function<unsigned char(int x, int y)>& wallMask) {
+    width     = w;
+    height    = h;
+    seed      = mazeSeed;
+    algorithm = mazeAlgorithm;
+    rng.seed(mazeSeed);
+
+    grid.assign(height, vector<Cell>(width));
+    initializeGrid();
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        unsigned char mask = wallMask(x, y);
+        grid[y][x].visited = true;
+        for (int dir = 0; dir < 4; dir++)
+          grid[y][x].walls[dir] = (mask >> dir) & 1;
+      }
+    }
+
+    wallCounter = 0;
+    generateWalls();
+  }
+
+  // Intervalo [begin, end) das paredes geradas pela célula (x, y) em getWallNames()
+  void getCellWallRange(int x, int y, int& begin, int& end) const {
+    int cell = y * width + x;
+    begin    = cellWallOffsets[cell];
+    end      = cellWallOffsets[cell + 1];
+  }
+
   // Função para verificar se uma posição de célula é válida e acessível
   bool isValidPosition(int x, int y) const {
     if (x < 0 || x >= width || y < 0 || y >= height) {
@@ -483,72 +875,122 @@ class MazeGenerator {
     cout << "Múltiplas entradas e saídas criadas\n";
   }
 
-  // Função para salvar o labirinto como imagem PPM
-  void saveToPPM(const string& filename) const {
-    ofstream file(filename);
-    if (!file.is_open()) {
+  // Salva o labirinto como imagem PPM binária (P6), com cellPixels x
+  // cellPixels pixels por célula: paredes em preto e caminhos em branco.
+  //
+  // A imagem é rasterizada em faixas de linhas de células, cada uma em um
+  // buffer reaproveitado, e gravada com uma escrita por faixa. As faixas de
+  // um lote são rasterizadas em paralelo (uma por thread) e gravadas em ordem.
+  void saveToPPM(const string& filename, int cellPixels = 10, unsigned int numThreads = thread::hardware_concurrency()) const {
+    auto startTime = chrono::steady_clock::now();
+
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (file == NULL) {
       cerr << "Erro: Não foi possível abrir o arquivo " << filename << " para escrita.\n";
       return;
     }
 
-    // Calcular dimensões da imagem (cada célula = 10x10 pixels)
-    const int cellPixels  = 10;
-    const int imageWidth  = width * cellPixels;
-    const int imageHeight = height * cellPixels;
-
-    // Escrever cabeçalho PPM
-    file << "P3\n";
-    file << imageWidth << " " << imageHeight << "\n";
-    file << "255\n";
-
-    // Cores
-    const int wallColor[3] = {0, 0, 0};       // Preto para paredes
-    const int pathColor[3] = {255, 255, 255}; // Branco para caminhos
-
-    // Gerar imagem pixel por pixel
-    for (int y = 0; y < imageHeight; y++) {
-      for (int x = 0; x < imageWidth; x++) {
-        // Determinar qual célula do grid corresponde a este pixel
-        int cellX = x / cellPixels;
-        int cellY = y / cellPixels;
-
-        // Posição dentro da célula (0-9)
-        int pixelX = x % cellPixels;
-        int pixelY = y % cellPixels;
-
-        bool isWall = false;
-
-        // Verificar se estamos numa borda de parede
-        if (cellX < width && cellY < height) {
-          // Parede norte (topo da célula)
-          if (pixelY == 0 && grid[cellY][cellX].walls[0]) {
-            isWall = true;
-          }
-          // Parede sul (fundo da célula)
-          else if (pixelY == cellPixels - 1 && grid[cellY][cellX].walls[1]) {
-            isWall = true;
-          }
-          // Parede oeste (esquerda da célula)
-          else if (pixelX == 0 && grid[cellY][cellX].walls[3]) {
-            isWall = true;
-          }
-          // Parede leste (direita da célula)
-          else if (pixelX == cellPixels - 1 && grid[cellY][cellX].walls[2]) {
-            isWall = true;
-          }
-        }
+    cellPixels = max(cellPixels, 2);
+    numThreads = max(numThreads, 1u);
+
+    const size_t imageWidth  = static_cast<size_t>(width) * cellPixels;
+    const size_t imageHeight = static_cast<size_t>(height) * cellPixels;
+    const size_t rowBytes    = imageWidth * 3;
+    fprintf(file, "P6\n%zu %zu\n255\n", imageWidth, imageHeight);
+
+    // Linhas de células por faixa, para buffers de uns 4 MB
+    const size_t bandBytes = static_cast<size_t>(cellPixels) * rowBytes;
+    const int    bandRows  = static_cast<int>(max<size_t>(1, (4u << 20) / bandBytes));
+
+    vector<vector<unsigned char>> buffers(numThreads, vector<unsigned char>(bandRows * bandBytes));
+    vector<thread>                threads;
+
+    bool ok = true;
+    for (int y0 = 0; y0 < height && ok; y0 += bandRows * static_cast<int>(numThreads)) {
+      threads.clear();
+      for (unsigned int t = 0; t < numThreads; t++) {
+        int bandBegin = y0 + static_cast<int>(t) * bandRows;
+        int bandEnd   = min(bandBegin + bandRows, height);
+        if (bandBegin >= bandEnd)
+          break;
+        threads.emplace_back(&MazeGenerator::rasterizeRows, this, bandBegin, bandEnd, cellPixels, buffers[t].data());
+      }
+      for (thread& worker : threads)
+        worker.join();
+
+      for (size_t t = 0; t < threads.size() && ok; t++) {
+        int    bandBegin = y0 + static_cast<int>(t) * bandRows;
+        int    bandEnd   = min(bandBegin + bandRows, height);
+        size_t bytes     = (bandEnd - bandBegin) * bandBytes;
+        ok               = fwrite(buffers[t].data(), 1, bytes, file) == bytes;
+      }
+    }
+
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+      cerr << "Erro ao escrever o arquivo " << filename << "\n";
+      return;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    printf("Labirinto salvo como %s (%zux%zu pixels, %.2f s)\n", filename.c_str(), imageWidth, imageHeight, seconds);
+  }
+
+  // Versão compacta para labirintos enormes: bitmap PBM binário (P4), com
+  // 1 bit por pixel e um pixel por célula e por parede, de tamanho
+  // (2 * width + 1) x (2 * height + 1). A célula (x, y) é o pixel
+  // (2x + 1, 2y + 1), os pixels entre células vizinhas são as paredes (preto
+  // se existem) e os cantos são sempre pretos.
+  void saveToPBM(const string& filename) const {
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (file == NULL) {
+      cerr << "Erro: Não foi possível abrir o arquivo " << filename << " para escrita.\n";
+      return;
+    }
+
+    const int imageWidth  = 2 * width + 1;
+    const int imageHeight = 2 * height + 1;
+    fprintf(file, "P4\n%d %d\n", imageWidth, imageHeight);
+
+    // No P4 cada linha é um bitset (bit mais significativo primeiro, 1 = preto)
+    const size_t          rowBytes = (imageWidth + 7) / 8;
+    vector<unsigned char> rows(2 * rowBytes);
+    auto                  setBlack = [](unsigned char* row, int px) { row[px >> 3] |= 0x80 >> (px & 7); };
 
-        // Escrever cor do pixel
-        if (isWall) {
-          file << wallColor[0] << " " << wallColor[1] << " " << wallColor[2] << " ";
-        } else {
-          file << pathColor[0] << " " << pathColor[1] << " " << pathColor[2] << " ";
+    bool ok = true;
+    for (int y = 0; y <= height && ok; y++) {
+      // Linha de paredes horizontais acima da linha de células y, e a linha
+      // das próprias células (exceto depois da última)
+      unsigned char* edges = rows.data();
+      unsigned char* cells = rows.data() + rowBytes;
+      fill(rows.begin(), rows.end(), 0);
+
+      for (int x = 0; x < width; x++) {
+        bool wall = (y < height && grid[y][x].walls[0]) || (y > 0 && grid[y - 1][x].walls[1]);
+        setBlack(edges, 2 * x);
+        if (wall)
+          setBlack(edges, 2 * x + 1);
+      }
+      setBlack(edges, 2 * width);
+
+      size_t bytes = rowBytes;
+      if (y < height) {
+        for (int x = 0; x <= width; x++) {
+          bool wall = (x < width && grid[y][x].walls[3]) || (x > 0 && grid[y][x - 1].walls[2]);
+          if (wall)
+            setBlack(cells, 2 * x);
         }
+        bytes += rowBytes;
       }
-      file << "\n";
+
+      ok = fwrite(rows.data(), 1, bytes, file) == bytes;
     }
 
-    file.close();
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+      cerr << "Erro ao escrever o arquivo " << filename << "\n";
+      return;
+    }
     cout << "Labirinto salvo como " << filename << "\n";
   }
 
@@ -557,6 +999,77 @@ class MazeGenerator {
     return x >= 0 && x < width && y >= 0 && y < height;
   }
 
+  // Rasteriza as linhas de células [y0, y1) da imagem de saveToPPM() em
+  // "out" (RGB, linha a linha). Cada linha de pixels é preenchida de branco
+  // e recebe as paredes da célula como trechos pretos.
+  void rasterizeRows(int y0, int y1, int cellPixels, unsigned char* out) const {
+    const size_t rowBytes  = static_cast<size_t>(width) * cellPixels * 3;
+    const size_t cellBytes = static_cast<size_t>(cellPixels) * 3;
+
+    for (int y = y0; y < y1; y++) {
+      for (int py = 0; py < cellPixels; py++) {
+        unsigned char* row = out + (static_cast<size_t>(y - y0) * cellPixels + py) * rowBytes;
+        memset(row, 255, rowBytes);
+
+        for (int x = 0; x < width; x++) {
+          const bool*    cellWalls = grid[y][x].walls;
+          unsigned char* cell      = row + x * cellBytes;
+
+          // Norte na primeira linha da célula, sul na última, e oeste e leste
+          // na primeira e última coluna
+          if ((py == 0 && cellWalls[0]) || (py == cellPixels - 1 && cellWalls[1])) {
+            memset(cell, 0, cellBytes);
+            continue;
+          }
+          if (cellWalls[3])
+            memset(cell, 0, 3);
+          if (cellWalls[2])
+            memset(cell + cellBytes - 3, 0, 3);
+        }
+      }
+    }
+  }
+
+  // DFS com backtracking restrito ao retângulo [x0, x1) x [y0, y1), começando
+  // do seu centro. Só altera células do retângulo, então blocos distintos
+  // podem ser gerados em paralelo.
+  void carveTile(int x0, int y0, int x1, int y1, mt19937& tileRng, vector<pair<int, int>>& stack) {
+    int startX = (x0 + x1) / 2;
+    int startY = (y0 + y1) / 2;
+
+    stack.clear();
+    grid[startY][startX].visited = true;
+    stack.push_back({startX, startY});
+
+    int neighbors[4];
+    while (!stack.empty()) {
+      int currentX = stack.back().first;
+      int currentY = stack.back().second;
+
+      int numNeighbors = 0;
+      for (int dir = 0; dir < 4; dir++) {
+        int newX = currentX + dx[dir];
+        int newY = currentY + dy[dir];
+        if (newX >= x0 && newX < x1 && newY >= y0 && newY < y1 && !grid[newY][newX].visited)
+          neighbors[numNeighbors++] = dir;
+      }
+
+      if (numNeighbors == 0) {
+        stack.pop_back();
+        continue;
+      }
+
+      int randomDir = neighbors[tileRng() % numNeighbors];
+      int newX      = currentX + dx[randomDir];
+      int newY      = currentY + dy[randomDir];
+
+      removeWall(currentX, currentY, newX, newY);
+
+      grid[newY][newX].visited = true;
+      stack.push_back({newX, newY});
+    }
+  }
+
   void removeWall(int x1, int y1, int x2, int y2) {
     if (x1 == x2) {                    // Movimento vertical
       if (y1 < y2) {                   // Movendo para sul
@@ -0,0 +1,406 @@
+#ifndef MAZEFILE_HPP
+#define MAZEFILE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "maze.hpp"
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Formato binário de labirinto (".maze"), versionado. O arquivo começa com
+// MazeFileHeader, seguido das seções abaixo, cada uma alinhada a 16 bytes:
+//
+//   paredes    4 bits por célula, duas células por byte (a de x par no nibble
+//              baixo), linha a linha; bits como em MazeGenerator::getWallMask()
+//   caixas     (opcional) paredes vizinhas alinhadas unidas em caixas, em
+//              coordenadas do labirinto (as mesmas de generateWalls())
+//   distâncias (opcional) distância em células, pelo labirinto, de cada
+//              célula até a célula de origem; kMazeFileUnreachable se não há
+//              caminho
+//
+// Os inteiros e floats são gravados na ordem de bytes da máquina (little
+// endian em todas as plataformas suportadas). Como todas as seções ficam
+// alinhadas, MazeFile pode mapear o arquivo na memória (mmap) e consultar
+// tudo diretamente, sem copiar.
+const char     kMazeFileMagic[4]    = {'M', 'A', 'Z', 'E'};
+const uint32_t kMazeFileVersion     = 1;
+const uint32_t kMazeFileUnreachable = 0xFFFFFFFFu;
+
+struct MazeFileHeader {
+  char     magic[4];
+  uint32_t version;
+  int32_t  width;
+  int32_t  height;
+  uint32_t seed;
+  uint32_t algorithm; // MazeAlgorithm
+  uint64_t walls_offset;
+  uint64_t boxes_offset; // 0 se não há caixas
+  uint64_t box_count;
+  uint64_t distances_offset; // 0 se não há distâncias
+  int32_t  distance_source_x;
+  int32_t  distance_source_y;
+};
+static_assert(sizeof(MazeFileHeader) == 64, "MazeFileHeader deve ter 64 bytes");
+
+struct MazeFileBox {
+  float min[3];
+  float max[3];
+};
+
+// Dados opcionais gravados por SaveMazeFile()
+struct MazeFileOptions {
+  bool boxes     = true;
+  bool distances = true;
+  int  sourceX   = -1; // Origem das distâncias; -1 = centro do labirinto
+  int  sourceY   = -1;
+};
+
+// Une as paredes do labirinto em caixas: cada trecho contínuo de paredes
+// horizontais (ou verticais) em uma mesma linha da grade vira uma caixa. A
+// parede entre duas células existe se qualquer uma das duas a tem, como em
+// generateWalls().
+void ComputeMazeWallBoxes(const MazeGenerator& maze, vector<MazeFileBox>& boxes) {
+  const int   width      = maze.getWidth();
+  const int   height     = maze.getHeight();
+  const float cellSize   = 2.0f;
+  const float halfT      = 0.1f;
+  const float wallHeight = 3.0f;
+
+  auto horizontal = [&](int x, int line) {
+    return (line < height && maze.hasWall(x, line, 0)) || (line > 0 && maze.hasWall(x, line - 1, 1));
+  };
+  auto vertical = [&](int line, int y) {
+    return (line < width && maze.hasWall(line, y, 3)) || (line > 0 && maze.hasWall(line - 1, y, 2));
+  };
+
+  boxes.clear();
+  for (int line = 0; line <= height; line++) {
+    float z = line * cellSize - cellSize / 2.0f;
+    for (int x = 0; x < width;) {
+      if (!horizontal(x, line)) {
+        x++;
+        continue;
+      }
+      int end = x + 1;
+      while (end < width && horizontal(end, line))
+        end++;
+
+      MazeFileBox box = {{x * cellSize - cellSize / 2.0f, 0.0f, z - halfT},
+                         {end * cellSize - cellSize / 2.0f, wallHeight, z + halfT}};
+      boxes.push_back(box);
+      x = end;
+    }
+  }
+
+  for (int line = 0; line <= width; line++) {
+    float wx = line * cellSize - cellSize / 2.0f;
+    for (int y = 0; y < height;) {
+      if (!vertical(line, y)) {
+        y++;
+        continue;
+      }
+      int end = y + 1;
+      while (end < height && vertical(line, end))
+        end++;
+
+      MazeFileBox box = {{wx - halfT, 0.0f, y * cellSize - cellSize / 2.0f},
+                         {wx + halfT, wallHeight, end * cellSize - cellSize / 2.0f}};
+      boxes.push_back(box);
+      y = end;
+    }
+  }
+}
+
+// Distância (busca em largura) de cada célula até (sourceX, sourceY)
+void ComputeMazeDistances(const MazeGenerator& maze, int sourceX, int sourceY, vector<uint32_t>& distances) {
+  const int width  = maze.getWidth();
+  const int height = maze.getHeight();
+  const int dx[4]  = {0, 0, 1, -1};
+  const int dy[4]  = {-1, 1, 0, 0};
+
+  distances.assign(static_cast<size_t>(width) * height, kMazeFileUnreachable);
+
+  vector<int> queue;
+  queue.reserve(distances.size());
+  queue.push_back(sourceY * width + sourceX);
+  distances[queue[0]] = 0;
+
+  for (size_t head = 0; head < queue.size(); head++) {
+    int x = queue[head] % width;
+    int y = queue[head] / width;
+    for (int dir = 0; dir < 4; dir++) {
+      int nx = x + dx[dir];
+      int ny = y + dy[dir];
+      if (nx < 0 || nx >= width || ny < 0 || ny >= height || maze.hasWall(x, y, dir))
+        continue;
+
+      int next = ny * width + nx;
+      if (distances[next] == kMazeFileUnreachable) {
+        distances[next] = distances[queue[head]] + 1;
+        queue.push_back(next);
+      }
+    }
+  }
+}
+
+// Grava o labirinto em "filename". Retorna false (e imprime o motivo) se
+// não foi possível escrever o arquivo.
+bool SaveMazeFile(const MazeGenerator& maze, const string& filename, const MazeFileOptions& options = MazeFileOptions()) {
+  const int width  = maze.getWidth();
+  const int height = maze.getHeight();
+
+  auto align = [](uint64_t offset) { return (offset + 15) & ~uint64_t(15); };
+
+  // Paredes: uma linha de nibbles por vez, para não montar o arquivo inteiro
+  const size_t        rowBytes = (static_cast<size_t>(width) + 1) / 2;
+  const uint64_t      wallsEnd = sizeof(MazeFileHeader) + uint64_t(rowBytes) * height;
+  vector<MazeFileBox> boxes;
+  vector<uint32_t>    distances;
+  MazeFileHeader      header;
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMazeFileMagic, sizeof(header.magic));
+  header.version      = kMazeFileVersion;
+  header.width        = width;
+  header.height       = height;
+  header.seed         = maze.getSeed();
+  header.algorithm    = maze.getAlgorithm();
+  header.walls_offset = sizeof(MazeFileHeader);
+
+  uint64_t end = wallsEnd;
+  if (options.boxes) {
+    ComputeMazeWallBoxes(maze, boxes);
+    header.boxes_offset = align(end);
+    header.box_count    = boxes.size();
+    end                 = header.boxes_offset + boxes.size() * sizeof(MazeFileBox);
+  }
+  if (options.distances) {
+    header.distance_source_x = options.sourceX >= 0 ? options.sourceX : width / 2;
+    header.distance_source_y = options.sourceY >= 0 ? options.sourceY : height / 2;
+    ComputeMazeDistances(maze, header.distance_source_x, header.distance_source_y, distances);
+    header.distances_offset = align(end);
+  }
+
+  FILE* file = fopen(filename.c_str(), "wb");
+  if (file == NULL) {
+    fprintf(stderr, "Erro: não foi possível abrir \"%s\" para escrita.\n", filename.c_str());
+    return false;
+  }
+
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+  vector<unsigned char> row(rowBytes);
+  for (int y = 0; y < height && ok; y++) {
+    fill(row.begin(), row.end(), 0);
+    for (int x = 0; x < width; x++)
+      row[x / 2] |= maze.getWallMask(x, y) << (4 * (x & 1));
+    ok = fwrite(row.data(), 1, row.size(), file) == row.size();
+  }
+
+  // Preenche com zeros até o início da próxima seção
+  uint64_t position = wallsEnd;
+  auto     writeAt  = [&](uint64_t offset, const void* data, size_t bytes) {
+    static const unsigned char zeros[16] = {0};
+    ok = ok && fwrite(zeros, 1, static_cast<size_t>(offset - position), file) == offset - position;
+    ok = ok && fwrite(data, 1, bytes, file) == bytes;
+    position = offset + bytes;
+  };
+
+  if (options.boxes)
+    writeAt(header.boxes_offset, boxes.data(), boxes.size() * sizeof(MazeFileBox));
+  if (options.distances)
+    writeAt(header.distances_offset, distances.data(), distances.size() * sizeof(uint32_t));
+
+  ok = (fclose(file) == 0) && ok;
+  if (!ok)
+    fprintf(stderr, "Erro ao escrever o labirinto em \"%s\".\n", filename.c_str());
+  return ok;
+}
+
+// Arquivo de labirinto aberto para leitura. No Linux e no macOS o arquivo é
+// mapeado na memória e as consultas leem direto das páginas mapeadas; no
+// Windows ele é lido inteiro para um buffer.
+class MazeFile {
+  public:
+  MazeFile() = default;
+  MazeFile(const MazeFile&) = delete;
+  MazeFile& operator=(const MazeFile&) = delete;
+
+  ~MazeFile() {
+    close();
+  }
+
+  // Abre e valida o arquivo. Retorna false (e imprime o motivo) se ele não
+  // existe, não é um labirinto ou está truncado.
+  bool open(const string& filename) {
+    close();
+
+#ifdef _WIN32
+    ifstream file(filename, ios::binary | ios::ate);
+    if (!file.is_open())
+      return fail(filename, "não foi possível abrir o arquivo");
+    buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    data = buffer.data();
+    size = buffer.size();
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return fail(filename, "não foi possível abrir o arquivo");
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+      ::close(fd);
+      return fail(filename, "arquivo vazio");
+    }
+
+    void* mapping = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // O mapeamento continua válido
+    if (mapping == MAP_FAILED)
+      return fail(filename, "mmap falhou");
+
+    data = static_cast<const unsigned char*>(mapping);
+    size = static_cast<size_t>(info.st_size);
+#endif
+
+    if (!validate()) {
+      close();
+      return fail(filename, "formato inválido ou arquivo truncado");
+    }
+    return true;
+  }
+
+  void close() {
+#ifdef _WIN32
+    vector<unsigned char>().swap(buffer);
+#else
+    if (data != NULL)
+      munmap(const_cast<unsigned char*>(data), size);
+#endif
+    data   = NULL;
+    size   = 0;
+    header = NULL;
+  }
+
+  bool isOpen() const {
+    return header != NULL;
+  }
+
+  int getWidth() const {
+    return header->width;
+  }
+
+  int getHeight() const {
+    return header->height;
+  }
+
+  unsigned int getSeed() const {
+    return header->seed;
+  }
+
+  MazeAlgorithm getAlgorithm() const {
+    return static_cast<MazeAlgorithm>(header->algorithm);
+  }
+
+  // Paredes da célula (x, y), como em MazeGenerator::getWallMask()
+  unsigned char getWallMask(int x, int y) const {
+    const size_t  rowBytes = (static_cast<size_t>(header->width) + 1) / 2;
+    unsigned char byte     = data[header->walls_offset + y * rowBytes + x / 2];
+    return (byte >> (4 * (x & 1))) & 0xF;
+  }
+
+  bool hasWall(int x, int y, int dir) const {
+    return (getWallMask(x, y) >> dir) & 1;
+  }
+
+  // Caixas das paredes unidas (NULL se o arquivo não as tem)
+  const MazeFileBox* getBoxes() const {
+    return header->boxes_offset ? reinterpret_cast<const MazeFileBox*>(data + header->boxes_offset) : NULL;
+  }
+
+  size_t getBoxCount() const {
+    return header->boxes_offset ? static_cast<size_t>(header->box_count) : 0;
+  }
+
+  bool hasDistances() const {
+    return header->distances_offset != 0;
+  }
+
+  // Distância, em células, de (x, y) até a origem gravada no arquivo
+  uint32_t getDistance(int x, int y) const {
+    const uint32_t* distances = reinterpret_cast<const uint32_t*>(data + header->distances_offset);
+    return distances[static_cast<size_t>(y) * header->width + x];
+  }
+
+  void getDistanceSource(int& x, int& y) const {
+    x = header->distance_source_x;
+    y = header->distance_source_y;
+  }
+
+  // Recria o labirinto em "maze" (grid e paredes 3D)
+  void loadInto(MazeGenerator& maze) const {
+    maze.assignWalls(getWidth(), getHeight(), getSeed(), getAlgorithm(),
+                     [this](int x, int y) { return getWallMask(x, y); });
+  }
+
+  private:
+  bool fail(const string& filename, const char* reason) {
+    fprintf(stderr, "Erro ao carregar o labirinto \"%s\": %s.\n", filename.c_str(), reason);
+    return false;
+  }
+
+  // Confere o cabeçalho e se todas as seções cabem no arquivo
+  bool validate() {
+    if (size < sizeof(MazeFileHeader))
+      return false;
+
+    const MazeFileHeader* h = reinterpret_cast<const MazeFileHeader*>(data);
+    if (memcmp(h->magic, kMazeFileMagic, sizeof(h->magic)) != 0 || h->version != kMazeFileVersion)
+      return false;
+    if (h->width <= 0 || h->height <= 0)
+      return false;
+
+    const uint64_t cells    = uint64_t(h->width) * uint64_t(h->height);
+    const uint64_t rowBytes = (uint64_t(h->width) + 1) / 2;
+
+    auto fits = [&](uint64_t offset, uint64_t bytes, uint64_t alignment) {
+      return offset % alignment == 0 && offset <= size && bytes <= size - offset;
+    };
+
+    if (!fits(h->walls_offset, rowBytes * uint64_t(h->height), 1))
+      return false;
+    if (h->boxes_offset && (h->box_count > size || !fits(h->boxes_offset, h->box_count * sizeof(MazeFileBox), 4)))
+      return false;
+    if (h->distances_offset) {
+      if (cells > size || !fits(h->distances_offset, cells * sizeof(uint32_t), 4))
+        return false;
+      if (h->distance_source_x < 0 || h->distance_source_x >= h->width ||
+          h->distance_source_y < 0 || h->distance_source_y >= h->height)
+        return false;
+    }
+
+    header = h;
+    return true;
+  }
+
+  const unsigned char*  data   = NULL;
+  size_t                size   = 0;
+  const MazeFileHeader* header = NULL;
+#ifdef _WIN32
+  vector<unsigned char> buffer;
+#endif
+};
+
+#endif // MAZEFILE_HPP
@@ -0,0 +1,214 @@
+#ifndef MAZEPATHS_HPP
+#define MAZEPATHS_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "maze.hpp"
+
+// Consultas de caminho mínimo em labirintos perfeitos. As passagens de um
+// labirinto perfeito formam uma árvore geradora sobre as células (as
+// entradas de createMultipleEntrances() só abrem a borda externa), então o
+// caminho entre duas células é único e passa pelo ancestral comum mais baixo
+// (LCA) das duas, com a árvore enraizada em uma célula qualquer.
+//
+// build() calcula, para cada célula, o pai, a profundidade e um "salto"
+// (jump pointer em skew-binary, Myers 1983), o que permite subir na árvore
+// e achar o LCA em O(log n) com memória O(n). As tabelas de binary lifting
+// teriam log(n) entradas por célula (centenas de MB em um labirinto de
+// 2000x2000).
+//
+// Se o labirinto não é uma árvore (passagens extras, células isoladas) ou
+// mudou depois de build() (veja MazeGenerator::getRevision()), as consultas
+// caem para uma busca em largura, mais lenta mas sempre correta.
+class MazeTreePaths {
+  public:
+  // Calcula as tabelas para o labirinto, enraizado na célula central
+  void build(const MazeGenerator& maze) {
+    this->maze = &maze;
+    width      = maze.getWidth();
+    height     = maze.getHeight();
+    revision   = maze.getRevision();
+
+    const int    numCells = width * height;
+    const int    root     = (height / 2) * width + width / 2;
+    const int    dx[4]    = {0, 0, 1, -1};
+    const int    dy[4]    = {-1, 1, 0, 0};
+    const size_t none     = numCells;
+
+    parent.assign(numCells, static_cast<uint32_t>(none));
+    jump.assign(numCells, static_cast<uint32_t>(none));
+    depth.assign(numCells, 0);
+
+    // Busca em largura a partir da raiz. Como os pais são visitados antes dos
+    // filhos, o salto de cada célula pode ser calculado na hora.
+    vector<uint32_t>& queue = searchQueue;
+    queue.clear();
+    queue.push_back(root);
+    parent[root] = root;
+    jump[root]   = root;
+
+    size_t passages = 0; // Cada passagem interna é contada dos dois lados
+    for (size_t head = 0; head < queue.size(); head++) {
+      const uint32_t cell = queue[head];
+      const int      x    = cell % width;
+      const int      y    = cell / width;
+
+      for (int dir = 0; dir < 4; dir++) {
+        int nx = x + dx[dir];
+        int ny = y + dy[dir];
+        if (nx < 0 || nx >= width || ny < 0 || ny >= height || maze.hasWall(x, y, dir))
+          continue;
+
+        passages++;
+        uint32_t next = ny * width + nx;
+        if (parent[next] != none)
+          continue;
+
+        parent[next] = cell;
+        depth[next]  = depth[cell] + 1;
+
+        // Se os dois saltos acima do pai têm o mesmo tamanho, o salto do filho
+        // cobre os dois; senão ele salta só para o pai
+        uint32_t j1 = jump[cell];
+        uint32_t j2 = jump[j1];
+        jump[next]  = (depth[cell] - depth[j1] == depth[j1] - depth[j2]) ? j2 : cell;
+
+        queue.push_back(next);
+      }
+    }
+
+    // Árvore: todas as células alcançadas e exatamente numCells - 1 passagens
+    tree = (queue.size() == static_cast<size_t>(numCells)) && (passages / 2 == static_cast<size_t>(numCells) - 1);
+    if (!tree)
+      fprintf(stderr, "Aviso: o labirinto não é uma árvore; caminhos serão calculados por busca.\n");
+  }
+
+  // Indica se as consultas usam as tabelas (O(log n)) e não a busca
+  bool isFast() const {
+    return maze != NULL && tree && revision == maze->getRevision();
+  }
+
+  // Número de passos do caminho entre as células (ax, ay) e (bx, by), ou -1
+  // se não há caminho
+  int distance(int ax, int ay, int bx, int by) const {
+    const int      w = maze->getWidth();
+    const uint32_t a = ay * w + ax;
+    const uint32_t b = by * w + bx;
+    if (!isFast())
+      return search(a, b, NULL);
+
+    uint32_t ancestor = lca(a, b);
+    return static_cast<int>(depth[a] + depth[b] - 2 * depth[ancestor]);
+  }
+
+  // Próxima célula no caminho de (ax, ay) até (bx, by). Retorna false se não
+  // há caminho; se a == b, a própria célula.
+  bool nextStep(int ax, int ay, int bx, int by, int& nextX, int& nextY) const {
+    const int      w = maze->getWidth();
+    const uint32_t a = ay * w + ax;
+    const uint32_t b = by * w + bx;
+    uint32_t       next;
+
+    if (!isFast()) {
+      if (search(a, b, &next) < 0)
+        return false;
+    } else if (a == b) {
+      next = a;
+    } else if (lca(a, b) != a) {
+      next = parent[a]; // O caminho sobe a partir de a
+    } else {
+      next = ancestorAtDepth(b, depth[a] + 1); // a é ancestral de b: desce
+    }
+
+    nextX = next % w;
+    nextY = next / w;
+    return true;
+  }
+
+  private:
+  // Ancestral de v com profundidade d (d <= depth[v])
+  uint32_t ancestorAtDepth(uint32_t v, uint32_t d) const {
+    while (depth[v] > d)
+      v = (depth[jump[v]] >= d) ? jump[v] : parent[v];
+    return v;
+  }
+
+  uint32_t lca(uint32_t a, uint32_t b) const {
+    if (depth[a] > depth[b])
+      a = ancestorAtDepth(a, depth[b]);
+    else
+      b = ancestorAtDepth(b, depth[a]);
+
+    // Na mesma profundidade os saltos têm o mesmo tamanho, então a e b sobem
+    // juntos: pelo salto se ele não passa do LCA, senão pelo pai
+    while (a != b) {
+      if (jump[a] != jump[b]) {
+        a = jump[a];
+        b = jump[b];
+      } else {
+        a = parent[a];
+        b = parent[b];
+      }
+    }
+    return a;
+  }
+
+  // Busca em largura de b até a, usada quando as tabelas não valem. Retorna
+  // a distância (ou -1) e, em "next", o vizinho de a no caminho.
+  int search(uint32_t a, uint32_t b, uint32_t* next) const {
+    const int width  = maze->getWidth();
+    const int height = maze->getHeight();
+    const int dx[4]  = {0, 0, 1, -1};
+    const int dy[4]  = {-1, 1, 0, 0};
+
+    searchParent.assign(static_cast<size_t>(width) * height, UINT32_MAX);
+    searchQueue.clear();
+    searchQueue.push_back(b);
+    searchParent[b] = b;
+
+    for (size_t head = 0; head < searchQueue.size(); head++) {
+      const uint32_t cell = searchQueue[head];
+      if (cell == a) {
+        int steps = 0;
+        for (uint32_t v = a; v != b; v = searchParent[v])
+          steps++;
+        if (next != NULL)
+          *next = searchParent[a];
+        return steps;
+      }
+
+      const int x = cell % width;
+      const int y = cell / width;
+      for (int dir = 0; dir < 4; dir++) {
+        int nx = x + dx[dir];
+        int ny = y + dy[dir];
+        if (nx < 0 || nx >= width || ny < 0 || ny >= height || maze->hasWall(x, y, dir))
+          continue;
+
+        uint32_t neighbor = ny * width + nx;
+        if (searchParent[neighbor] == UINT32_MAX) {
+          searchParent[neighbor] = cell;
+          searchQueue.push_back(neighbor);
+        }
+      }
+    }
+    return -1;
+  }
+
+  const MazeGenerator* maze     = NULL;
+  int                  width    = 0;
+  int                  height   = 0;
+  unsigned int         revision = 0;
+  bool                 tree     = false;
+
+  vector<uint32_t> parent;
+  vector<uint32_t> jump;
+  vector<uint32_t> depth;
+
+  // Buffers reaproveitados entre buscas
+  mutable vector<uint32_t> searchQueue;
+  mutable vector<uint32_t> searchParent;
+};
+
+#endif // MAZEPATHS_HPP
@@ -0,0 +1,551 @@
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+#include "maze.hpp"
+
+// Vértice intercalado (posição, normal e coordenada de textura) guardado em
+// um único VBO. O "w" da posição (1) e da normal (0) não é armazenado: o
+// OpenGL completa atributos com menos componentes com (0, 0, 0, 1), e o
+// vertex shader descarta o "w" da normal transformada.
+struct PackedVertex {
+  float position[3];
+  float normal[3];
+  float texcoord[2];
+};
+
+// Vértice comprimido (12 bytes), opcional. A posição é quantizada em 16 bits
+// por eixo relativa à bounding box do objeto, a normal é codificada em 2x8
+// bits com o mapeamento octaédrico e a coordenada de textura é guardada em
+// meia precisão. O vertex shader decodifica os três (veja
+// "shader_vertex.glsl").
+struct QuantizedVertex {
+  uint16_t position[3]; // GL_UNSIGNED_SHORT normalizado: 0 = bbox_min, 65535 = bbox_max
+  int8_t   normal[2];   // GL_BYTE normalizado, octaédrico
+  uint16_t texcoord[2]; // GL_HALF_FLOAT
+};
+
+// Hash e igualdade bit a bit dos atributos, usados para soldar vértices
+// idênticos (mesma posição, normal e coordenada de textura).
+struct PackedVertexHash {
+  size_t operator()(const PackedVertex& v) const {
+    // FNV-1a sobre os bytes do vértice
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+    uint64_t             hash  = 1469598103934665603ull;
+    for (size_t i = 0; i < sizeof(PackedVertex); i++) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+  }
+};
+
+struct PackedVertexEqual {
+  bool operator()(const PackedVertex& a, const PackedVertex& b) const {
+    return memcmp(&a, &b, sizeof(PackedVertex)) == 0;
+  }
+};
+
+// Intervalo contíguo do index buffer com triângulos de um mesmo material
+struct MeshGroup {
+  int    material_id;
+  size_t first_index;
+  size_t index_count;
+};
+
+// Versão simplificada de um shape (veja GenerateLODs() em "lod.hpp"). Usa o
+// mesmo vertex buffer, com triângulos próprios no final do index buffer.
+struct MeshLevel {
+  std::vector<MeshGroup> groups;
+  float                  error; // Erro geométrico, em unidades do modelo
+};
+
+// Um objeto (shape) do arquivo OBJ dentro da malha indexada
+struct MeshShape {
+  std::string            name;
+  std::vector<MeshGroup> groups;
+  std::vector<MeshLevel> lods; // Níveis 1, 2, ...; o nível 0 é "groups"
+  glm::vec3              bbox_min;
+  glm::vec3              bbox_max;
+};
+
+// Malha indexada de um ObjModel inteiro. Todos os shapes compartilham o mesmo
+// vertex buffer e index buffer.
+struct IndexedMesh {
+  std::vector<PackedVertex> vertices;
+  std::vector<uint32_t>     indices;
+  std::vector<MeshShape>    shapes;
+
+  bool   has_normals   = false;
+  bool   has_texcoords = false;
+  size_t num_corners   = 0; // Vértices antes da soldagem (3 por triângulo)
+
+  // ACMR antes e depois de OptimizeIndexedMesh() (0 se não foi otimizada)
+  float acmr_before = 0.0f;
+  float acmr_after  = 0.0f;
+
+  // Os vértices foram enviados à GPU no formato QuantizedVertex?
+  bool quantized = false;
+
+  // Os índices cabem em 16 bits?
+  bool useShortIndices() const {
+    return vertices.size() <= std::numeric_limits<uint16_t>::max() + size_t(1);
+  }
+
+  // Bytes ocupados na GPU (vertex buffer + index buffer)
+  size_t getGpuBytes() const {
+    size_t index_size = useShortIndices() ? sizeof(uint16_t) : sizeof(uint32_t);
+    size_t vertex_size = quantized ? sizeof(QuantizedVertex) : sizeof(PackedVertex);
+    return vertices.size() * vertex_size + indices.size() * index_size;
+  }
+
+  // Bytes que o formato antigo ocupava: um vértice por canto do triângulo,
+  // com vec4 de posição, vec4 de normal e vec2 de textura em VBOs separados,
+  // e índices de 32 bits.
+  size_t getUnweldedGpuBytes() const {
+    size_t bytes_per_corner = 4 * sizeof(float) + sizeof(uint32_t);
+    if (has_normals)
+      bytes_per_corner += 4 * sizeof(float);
+    if (has_texcoords)
+      bytes_per_corner += 2 * sizeof(float);
+    return num_corners * bytes_per_corner;
+  }
+};
+
+// Converte um ObjModel (já triangulado) em uma malha indexada. Cantos com
+// atributos idênticos são soldados em um único vértice, e os triângulos de
+// cada shape são ordenados por material, de forma que cada grupo possa ser
+// desenhado com uma única chamada glDrawElements().
+void BuildIndexedMesh(const ObjModel& model, IndexedMesh& mesh) {
+  const tinyobj::attrib_t& attrib = model.attrib;
+
+  std::unordered_map<PackedVertex, uint32_t, PackedVertexHash, PackedVertexEqual> vertex_map;
+
+  for (size_t shape = 0; shape < model.shapes.size(); ++shape) {
+    const tinyobj::mesh_t& objmesh   = model.shapes[shape].mesh;
+    size_t                 num_faces = objmesh.num_face_vertices.size();
+
+    MeshShape meshshape;
+    meshshape.name     = model.shapes[shape].name;
+    meshshape.bbox_min = glm::vec3(std::numeric_limits<float>::max());
+    meshshape.bbox_max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    // Agrupamos as faces por material
+    std::map<int, std::vector<size_t>> faces_by_material;
+    for (size_t face = 0; face < num_faces; ++face) {
+      assert(objmesh.num_face_vertices[face] == 3);
+      faces_by_material[objmesh.material_ids[face]].push_back(face);
+    }
+
+    for (const auto& pair : faces_by_material) {
+      MeshGroup group;
+      group.material_id = pair.first;
+      group.first_index = mesh.indices.size();
+
+      for (size_t face : pair.second) {
+        for (size_t vertex = 0; vertex < 3; ++vertex) {
+          tinyobj::index_t idx = objmesh.indices[3 * face + vertex];
+
+          PackedVertex v;
+          memset(&v, 0, sizeof(v));
+
+          for (int i = 0; i < 3; ++i)
+            v.position[i] = attrib.vertices[3 * idx.vertex_index + i];
+
+          meshshape.bbox_min = glm::min(meshshape.bbox_min, glm::vec3(v.position[0], v.position[1], v.position[2]));
+          meshshape.bbox_max = glm::max(meshshape.bbox_max, glm::vec3(v.position[0], v.position[1], v.position[2]));
+
+          if (idx.normal_index != -1) {
+            mesh.has_normals = true;
+            for (int i = 0; i < 3; ++i)
+              v.normal[i] = attrib.normals[3 * idx.normal_index + i];
+          }
+
+          if (idx.texcoord_index != -1) {
+            mesh.has_texcoords = true;
+            v.texcoord[0]      = attrib.texcoords[2 * idx.texcoord_index + 0];
+            v.texcoord[1]      = attrib.texcoords[2 * idx.texcoord_index + 1];
+          }
+
+          // Procuramos um vértice idêntico já emitido; se não existe, criamos
+          auto it = vertex_map.find(v);
+          if (it == vertex_map.end()) {
+            uint32_t new_index = static_cast<uint32_t>(mesh.vertices.size());
+            vertex_map.insert(std::make_pair(v, new_index));
+            mesh.vertices.push_back(v);
+            mesh.indices.push_back(new_index);
+          } else {
+            mesh.indices.push_back(it->second);
+          }
+
+          mesh.num_corners++;
+        }
+      }
+
+      group.index_count = mesh.indices.size() - group.first_index;
+      meshshape.groups.push_back(group);
+    }
+
+    mesh.shapes.push_back(meshshape);
+  }
+}
+
+// Tamanho da cache de vértices pós-transformação simulada pelas rotinas
+// abaixo. GPUs reais têm caches maiores ou organizadas de outra forma, mas
+// uma ordem boa para uma FIFO de 16 entradas é boa para todas elas.
+const unsigned int kVertexCacheSize = 16;
+
+// Average Cache Miss Ratio: número médio de vértices transformados por
+// triângulo, simulando uma cache FIFO de kVertexCacheSize entradas. Vai de
+// 3 (nenhum reaproveitamento) até perto de 0.5 em malhas regulares.
+float ComputeACMR(const uint32_t* indices, size_t index_count, size_t vertex_count) {
+  if (index_count == 0)
+    return 0.0f;
+
+  // Cada vértice guarda o "instante" em que entrou na cache; ele está na
+  // cache se entrou há menos de kVertexCacheSize falhas.
+  std::vector<size_t> cache_time(vertex_count, 0);
+  size_t              misses = 0;
+
+  for (size_t i = 0; i < index_count; i++) {
+    uint32_t v = indices[i];
+    if (cache_time[v] == 0 || misses - cache_time[v] >= kVertexCacheSize) {
+      misses++;
+      cache_time[v] = misses;
+    }
+  }
+
+  return static_cast<float>(misses) / (index_count / 3);
+}
+
+// Reordena os triângulos de indices[0..index_count) para aproveitar a cache
+// de vértices, usando o algoritmo Tipsify (Sander, Nehab e Barczak, 2007):
+// emite todos os triângulos em volta de um vértice "leque" e escolhe como
+// próximo leque o vértice recém emitido que ainda estará na cache e tem
+// menos triângulos pendentes. "hard_boundaries", se não é NULL, recebe os
+// triângulos (na nova ordem) em que o algoritmo precisou recomeçar em um
+// vértice fora da cache.
+void OptimizeVertexCache(uint32_t* indices, size_t index_count, size_t vertex_count,
+                         std::vector<size_t>* hard_boundaries = NULL) {
+  const size_t num_triangles = index_count / 3;
+  if (num_triangles == 0)
+    return;
+
+  // Adjacência vértice -> triângulos, em formato compacto (CSR)
+  std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+  for (size_t i = 0; i < index_count; i++)
+    adjacency_offsets[indices[i] + 1]++;
+  for (size_t v = 0; v < vertex_count; v++)
+    adjacency_offsets[v + 1] += adjacency_offsets[v];
+
+  std::vector<uint32_t> adjacency(index_count);
+  std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+  for (size_t i = 0; i < index_count; i++)
+    adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+  // Número de triângulos ainda não emitidos que usam cada vértice
+  std::vector<uint32_t> live_triangles(vertex_count);
+  for (size_t v = 0; v < vertex_count; v++)
+    live_triangles[v] = adjacency_offsets[v + 1] - adjacency_offsets[v];
+
+  std::vector<size_t>   cache_time(vertex_count, 0);
+  std::vector<bool>     emitted(num_triangles, false);
+  std::vector<uint32_t> dead_end;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> output;
+  output.reserve(index_count);
+
+  size_t time   = kVertexCacheSize + 1;
+  size_t cursor = 0; // Próximo vértice a testar quando a pilha de becos esvazia
+
+  long fanning = indices[0];
+
+  while (fanning >= 0) {
+    candidates.clear();
+
+    const uint32_t f = static_cast<uint32_t>(fanning);
+    for (uint32_t a = adjacency_offsets[f]; a < adjacency_offsets[f + 1]; a++) {
+      uint32_t triangle = adjacency[a];
+      if (emitted[triangle])
+        continue;
+
+      for (int k = 0; k < 3; k++) {
+        uint32_t v = indices[3 * triangle + k];
+        output.push_back(v);
+        dead_end.push_back(v);
+        candidates.push_back(v);
+        live_triangles[v]--;
+        if (time - cache_time[v] > kVertexCacheSize)
+          cache_time[v] = time++;
+      }
+      emitted[triangle] = true;
+    }
+
+    // Próximo leque: o candidato com triângulos pendentes que ficará mais
+    // tempo na cache depois de emitir todos eles.
+    fanning       = -1;
+    long priority = -1;
+    for (uint32_t v : candidates) {
+      if (live_triangles[v] == 0)
+        continue;
+
+      long p = 0;
+      if (time - cache_time[v] + 2 * live_triangles[v] <= kVertexCacheSize)
+        p = static_cast<long>(time - cache_time[v]);
+
+      if (p > priority) {
+        priority = p;
+        fanning  = v;
+      }
+    }
+
+    if (fanning >= 0)
+      continue;
+
+    // Beco sem saída: tentamos os vértices emitidos mais recentemente e,
+    // se nenhum tem triângulos pendentes, o próximo vértice na ordem original.
+    while (!dead_end.empty() && fanning < 0) {
+      uint32_t v = dead_end.back();
+      dead_end.pop_back();
+      if (live_triangles[v] > 0)
+        fanning = v;
+    }
+
+    while (fanning < 0 && cursor < index_count) {
+      uint32_t v = indices[cursor++];
+      if (live_triangles[v] > 0)
+        fanning = v;
+    }
+
+    if (fanning >= 0 && hard_boundaries != NULL && time - cache_time[fanning] > kVertexCacheSize)
+      hard_boundaries->push_back(output.size() / 3);
+  }
+
+  std::copy(output.begin(), output.end(), indices);
+}
+
+// Reordena grupos ("clusters") de triângulos já otimizados para a cache, de
+// forma que os clusters voltados para fora da malha sejam desenhados
+// primeiro e escondam os demais, reduzindo overdraw (Sander et al., 2007).
+// Os clusters começam nos pontos em que OptimizeVertexCache() recomeçou e
+// são subdivididos enquanto o ACMR local ficar abaixo de "threshold" vezes o
+// ACMR do cluster original, o que limita a piora do ACMR final.
+void OptimizeOverdraw(uint32_t* indices, size_t index_count, const std::vector<PackedVertex>& vertices,
+                      const std::vector<size_t>& hard_boundaries, float threshold) {
+  const size_t num_triangles = index_count / 3;
+  if (num_triangles == 0)
+    return;
+
+  // Limites dos clusters "duros"
+  std::vector<size_t> hard(1, 0);
+  for (size_t b : hard_boundaries)
+    if (b > hard.back() && b < num_triangles)
+      hard.push_back(b);
+  hard.push_back(num_triangles);
+
+  // Subdivisão em clusters menores. "cache_time" guarda o número total de
+  // falhas quando o vértice entrou na cache; vértices que entraram antes de
+  // "reset" (início do cluster atual) são considerados fora dela.
+  std::vector<size_t> clusters;
+  std::vector<size_t> cache_time(vertices.size(), 0);
+  size_t              misses = 0;
+
+  auto simulate = [&](size_t triangle, size_t reset) {
+    for (int k = 0; k < 3; k++) {
+      uint32_t v = indices[3 * triangle + k];
+      if (cache_time[v] <= reset || misses - cache_time[v] >= kVertexCacheSize) {
+        misses++;
+        cache_time[v] = misses;
+      }
+    }
+  };
+
+  for (size_t c = 0; c + 1 < hard.size(); c++) {
+    const size_t begin = hard[c];
+    const size_t end   = hard[c + 1];
+
+    size_t reset = misses;
+    for (size_t t = begin; t < end; t++)
+      simulate(t, reset);
+    float cluster_acmr = static_cast<float>(misses - reset) / (end - begin);
+
+    clusters.push_back(begin);
+    reset        = misses;
+    size_t start = begin;
+    for (size_t t = begin; t < end; t++) {
+      simulate(t, reset);
+      if (t + 1 < end && static_cast<float>(misses - reset) / (t + 1 - start) <= threshold * cluster_acmr) {
+        clusters.push_back(t + 1);
+        start = t + 1;
+        reset = misses;
+      }
+    }
+  }
+  clusters.push_back(num_triangles);
+
+  // Centróide da malha, ponderado pela área dos triângulos
+  glm::vec3 mesh_centroid(0.0f);
+  float     mesh_area = 0.0f;
+
+  const size_t           num_clusters = clusters.size() - 1;
+  std::vector<glm::vec3> cluster_centroid(num_clusters, glm::vec3(0.0f));
+  std::vector<glm::vec3> cluster_normal(num_clusters, glm::vec3(0.0f));
+  std::vector<float>     cluster_area(num_clusters, 0.0f);
+
+  for (size_t c = 0; c < num_clusters; c++) {
+    for (size_t t = clusters[c]; t < clusters[c + 1]; t++) {
+      const PackedVertex& a = vertices[indices[3 * t + 0]];
+      const PackedVertex& b = vertices[indices[3 * t + 1]];
+      const PackedVertex& d = vertices[indices[3 * t + 2]];
+      glm::vec3 pa(a.position[0], a.position[1], a.position[2]);
+      glm::vec3 pb(b.position[0], b.position[1], b.position[2]);
+      glm::vec3 pd(d.position[0], d.position[1], d.position[2]);
+
+      glm::vec3 n      = glm::cross(pb - pa, pd - pa); // |n| = 2 * área
+      float     area   = glm::length(n);
+      glm::vec3 center = (pa + pb + pd) / 3.0f;
+
+      cluster_centroid[c] += center * area;
+      cluster_normal[c] += n;
+      cluster_area[c] += area;
+    }
+
+    mesh_centroid += cluster_centroid[c];
+    mesh_area += cluster_area[c];
+  }
+
+  if (mesh_area > 0.0f)
+    mesh_centroid /= mesh_area;
+
+  // Chave de ordenação: quanto o cluster está voltado para fora da malha
+  std::vector<float>  sort_key(num_clusters, 0.0f);
+  std::vector<size_t> order(num_clusters);
+  for (size_t c = 0; c < num_clusters; c++) {
+    order[c] = c;
+    if (cluster_area[c] > 0.0f) {
+      glm::vec3 centroid = cluster_centroid[c] / cluster_area[c];
+      float     length   = glm::length(cluster_normal[c]);
+      if (length > 0.0f)
+        sort_key[c] = glm::dot(centroid - mesh_centroid, cluster_normal[c] / length);
+    }
+  }
+
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return sort_key[a] > sort_key[b];
+  });
+
+  std::vector<uint32_t> output;
+  output.reserve(index_count);
+  for (size_t c : order)
+    output.insert(output.end(), indices + 3 * clusters[c], indices + 3 * clusters[c + 1]);
+
+  std::copy(output.begin(), output.end(), indices);
+}
+
+// Renumera os vértices na ordem em que são usados pelo index buffer, para
+// que a leitura do vertex buffer pela GPU seja o mais sequencial possível.
+void OptimizeVertexFetch(IndexedMesh& mesh) {
+  const uint32_t unused = std::numeric_limits<uint32_t>::max();
+
+  std::vector<uint32_t>     remap(mesh.vertices.size(), unused);
+  std::vector<PackedVertex> vertices;
+  vertices.reserve(mesh.vertices.size());
+
+  for (uint32_t& index : mesh.indices) {
+    if (remap[index] == unused) {
+      remap[index] = static_cast<uint32_t>(vertices.size());
+      vertices.push_back(mesh.vertices[index]);
+    }
+    index = remap[index];
+  }
+
+  mesh.vertices.swap(vertices);
+}
+
+// Otimiza uma malha para renderização: ordena os triângulos de cada grupo
+// para a cache de vértices (e, opcionalmente, para reduzir overdraw) e
+// depois os vértices para leitura sequencial. Os grupos continuam sendo
+// intervalos contíguos do index buffer, então nada muda para quem desenha.
+// O "overdraw_threshold" (ex: 1.05) é a piora máxima de ACMR aceita na troca
+// por menos overdraw; deve ser usado apenas em malhas opacas.
+void OptimizeIndexedMesh(IndexedMesh& mesh, bool optimize_overdraw = true, float overdraw_threshold = 1.05f) {
+  mesh.acmr_before = ComputeACMR(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+
+  for (const MeshShape& shape : mesh.shapes) {
+    for (const MeshGroup& group : shape.groups) {
+      uint32_t* indices = mesh.indices.data() + group.first_index;
+
+      std::vector<size_t> hard_boundaries;
+      OptimizeVertexCache(indices, group.index_count, mesh.vertices.size(), &hard_boundaries);
+
+      if (optimize_overdraw)
+        OptimizeOverdraw(indices, group.index_count, mesh.vertices, hard_boundaries, overdraw_threshold);
+    }
+  }
+
+  OptimizeVertexFetch(mesh);
+
+  mesh.acmr_after = ComputeACMR(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+}
+
+// Codifica uma normal unitária com o mapeamento octaédrico (Meyer et al.,
+// 2010): a esfera é projetada no octaedro |x| + |y| + |z| = 1, e o
+// hemisfério inferior é dobrado sobre o quadrado [-1, 1]^2.
+glm::vec2 EncodeOctahedral(glm::vec3 n) {
+  n /= std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+
+  glm::vec2 e(n.x, n.y);
+  if (n.z < 0.0f) {
+    e.x = (1.0f - std::fabs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+    e.y = (1.0f - std::fabs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+  }
+  return e;
+}
+
+// Gera a versão comprimida dos vértices de uma malha. A posição é
+// quantizada relativa a [bbox_min, bbox_max], que deve ser a mesma bounding
+// box enviada ao shader para a decodificação.
+void QuantizeVertices(const IndexedMesh& mesh, const glm::vec3& bbox_min, const glm::vec3& bbox_max,
+                      std::vector<QuantizedVertex>& out) {
+  glm::vec3 extent = bbox_max - bbox_min;
+  glm::vec3 scale;
+  for (int i = 0; i < 3; i++)
+    scale[i] = extent[i] > 0.0f ? 65535.0f / extent[i] : 0.0f;
+
+  out.resize(mesh.vertices.size());
+  for (size_t i = 0; i < mesh.vertices.size(); i++) {
+    const PackedVertex& v = mesh.vertices[i];
+    QuantizedVertex&    q = out[i];
+
+    for (int k = 0; k < 3; k++) {
+      float value   = (v.position[k] - bbox_min[k]) * scale[k] + 0.5f;
+      q.position[k] = static_cast<uint16_t>(glm::clamp(value, 0.0f, 65535.0f));
+    }
+
+    glm::vec3 normal(v.normal[0], v.normal[1], v.normal[2]);
+    glm::vec2 e = glm::vec2(0.0f);
+    if (glm::length(normal) > 0.0f)
+      e = EncodeOctahedral(glm::normalize(normal));
+    q.normal[0] = static_cast<int8_t>(std::round(glm::clamp(e.x, -1.0f, 1.0f) * 127.0f));
+    q.normal[1] = static_cast<int8_t>(std::round(glm::clamp(e.y, -1.0f, 1.0f) * 127.0f));
+
+    uint32_t uv   = glm::packHalf2x16(glm::vec2(v.texcoord[0], v.texcoord[1]));
+    q.texcoord[0] = static_cast<uint16_t>(uv & 0xFFFF);
+    q.texcoord[1] = static_cast<uint16_t>(uv >> 16);
+  }
+}
+
+#endif // MESH_HPP
@@ -0,0 +1,270 @@
+#ifndef MESHLET_HPP
+#define MESHLET_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+#include "collisions.hpp"
+#include "culling.hpp"
+#include "mesh.hpp"
+
+// Limites de um meshlet: poucos vértices e triângulos, para que cada um seja
+// pequeno o bastante para ser descartado individualmente.
+const size_t kMeshletMaxVertices  = 64;
+const size_t kMeshletMaxTriangles = 124;
+
+// Grupos com menos triângulos que isso não são divididos em meshlets: o
+// custo de testar os clusters não compensaria.
+const size_t kMeshletMinTriangles = 4096;
+
+// Um pedaço ("cluster") de um grupo de triângulos, com os volumes usados no
+// descarte: esfera envolvente e cone de normais (Wihlidal, 2016). Os
+// triângulos do meshlet são um intervalo contíguo do index buffer.
+struct Meshlet {
+  size_t first_index;
+  size_t index_count;
+
+  glm::vec3 center; // Esfera envolvente, em coordenadas do modelo
+  float     radius;
+
+  glm::vec3 cone_axis;   // Direção média das normais dos triângulos
+  float     cone_cutoff; // Seno da abertura do cone; 1 se o cone é aberto demais
+};
+
+// Dados de um objeto sendo desenhado, necessários para descartar seus
+// meshlets: matriz de modelagem, planos do frustum e posição da câmera (em
+// coordenadas globais).
+struct MeshletCullInfo {
+  glm::mat4               model;
+  const collision::Plane* planes;
+  glm::vec3               camera_position;
+};
+
+// Calcula a esfera envolvente e o cone de normais de um meshlet
+void ComputeMeshletBounds(const IndexedMesh& mesh, Meshlet& meshlet) {
+  const uint32_t* indices = mesh.indices.data() + meshlet.first_index;
+
+  glm::vec3 bbox_min(std::numeric_limits<float>::max());
+  glm::vec3 bbox_max(std::numeric_limits<float>::lowest());
+  for (size_t i = 0; i < meshlet.index_count; i++) {
+    const PackedVertex& v = mesh.vertices[indices[i]];
+    glm::vec3           p(v.position[0], v.position[1], v.position[2]);
+    bbox_min = glm::min(bbox_min, p);
+    bbox_max = glm::max(bbox_max, p);
+  }
+
+  meshlet.center = (bbox_min + bbox_max) * 0.5f;
+  meshlet.radius = 0.0f;
+  for (size_t i = 0; i < meshlet.index_count; i++) {
+    const PackedVertex& v = mesh.vertices[indices[i]];
+    glm::vec3           p(v.position[0], v.position[1], v.position[2]);
+    meshlet.radius = std::max(meshlet.radius, glm::length(p - meshlet.center));
+  }
+
+  // Normais das faces (e não dos vértices, que são suavizadas)
+  std::vector<glm::vec3> normals;
+  glm::vec3              axis(0.0f);
+  for (size_t t = 0; t < meshlet.index_count / 3; t++) {
+    const PackedVertex& a = mesh.vertices[indices[3 * t + 0]];
+    const PackedVertex& b = mesh.vertices[indices[3 * t + 1]];
+    const PackedVertex& c = mesh.vertices[indices[3 * t + 2]];
+    glm::vec3           pa(a.position[0], a.position[1], a.position[2]);
+    glm::vec3           pb(b.position[0], b.position[1], b.position[2]);
+    glm::vec3           pc(c.position[0], c.position[1], c.position[2]);
+
+    glm::vec3 n      = glm::cross(pb - pa, pc - pa);
+    float     length = glm::length(n);
+    if (length == 0.0f)
+      continue;
+
+    normals.push_back(n / length);
+    axis += n / length;
+  }
+
+  meshlet.cone_axis   = glm::vec3(0.0f, 1.0f, 0.0f);
+  meshlet.cone_cutoff = 1.0f;
+
+  float length = glm::length(axis);
+  if (length == 0.0f)
+    return;
+
+  axis /= length;
+  float min_dot = 1.0f;
+  for (const glm::vec3& n : normals)
+    min_dot = std::min(min_dot, glm::dot(axis, n));
+
+  // Cones com abertura perto de 90 graus quase nunca são descartados
+  meshlet.cone_axis = axis;
+  if (min_dot > 0.1f)
+    meshlet.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+}
+
+// Divide o intervalo [first_index, first_index + index_count) do index buffer
+// em meshlets, reordenando seus triângulos para que cada meshlet seja um
+// intervalo contíguo. Cada meshlet cresce a partir de um triângulo inicial
+// acrescentando triângulos vizinhos, preferindo os que trazem menos vértices
+// novos e, entre esses, os de normal mais próxima da média do meshlet (o que
+// deixa o cone de normais estreito). Um meshlet termina quando o próximo
+// triângulo excederia kMeshletMaxVertices vértices distintos ou
+// kMeshletMaxTriangles triângulos, ou quando não há mais vizinhos livres.
+void BuildMeshlets(IndexedMesh& mesh, size_t first_index, size_t index_count, std::vector<Meshlet>& out) {
+  const size_t num_triangles = index_count / 3;
+  const size_t num_vertices  = mesh.vertices.size();
+  uint32_t*    indices       = mesh.indices.data() + first_index;
+
+  // Adjacência vértice -> triângulos do intervalo (CSR)
+  std::vector<uint32_t> adjacency_offsets(num_vertices + 1, 0);
+  for (size_t i = 0; i < index_count; i++)
+    adjacency_offsets[indices[i] + 1]++;
+  for (size_t v = 0; v < num_vertices; v++)
+    adjacency_offsets[v + 1] += adjacency_offsets[v];
+
+  std::vector<uint32_t> adjacency(index_count);
+  {
+    std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+    for (size_t i = 0; i < index_count; i++)
+      adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+  }
+
+  // Normal de cada triângulo
+  std::vector<glm::vec3> normals(num_triangles, glm::vec3(0.0f));
+  for (size_t t = 0; t < num_triangles; t++) {
+    const PackedVertex& a = mesh.vertices[indices[3 * t + 0]];
+    const PackedVertex& b = mesh.vertices[indices[3 * t + 1]];
+    const PackedVertex& c = mesh.vertices[indices[3 * t + 2]];
+    glm::vec3           pa(a.position[0], a.position[1], a.position[2]);
+    glm::vec3           pb(b.position[0], b.position[1], b.position[2]);
+    glm::vec3           pc(c.position[0], c.position[1], c.position[2]);
+
+    glm::vec3 n      = glm::cross(pb - pa, pc - pa);
+    float     length = glm::length(n);
+    if (length > 0.0f)
+      normals[t] = n / length;
+  }
+
+  // "stamp[v]" guarda o número do meshlet que usou o vértice v por último
+  std::vector<uint32_t> stamp(num_vertices, 0);
+  std::vector<bool>     emitted(num_triangles, false);
+  std::vector<uint32_t> output;
+  std::vector<uint32_t> meshlet_vertices;
+  output.reserve(index_count);
+
+  uint32_t current       = 0;
+  size_t   seed          = 0; // Próximo triângulo não emitido, na ordem original
+  size_t   first_meshlet = out.size();
+
+  while (output.size() < index_count) {
+    while (emitted[seed])
+      seed++;
+
+    current++;
+    meshlet_vertices.clear();
+
+    Meshlet meshlet;
+    meshlet.first_index = first_index + output.size();
+
+    glm::vec3 axis(0.0f);
+    size_t    triangles = 0;
+    long      next      = static_cast<long>(seed);
+
+    while (next >= 0) {
+      const uint32_t t = static_cast<uint32_t>(next);
+      emitted[t]       = true;
+      axis += normals[t];
+      triangles++;
+      for (int k = 0; k < 3; k++) {
+        uint32_t v = indices[3 * t + k];
+        output.push_back(v);
+        if (stamp[v] != current) {
+          stamp[v] = current;
+          meshlet_vertices.push_back(v);
+        }
+      }
+
+      if (triangles == kMeshletMaxTriangles)
+        break;
+
+      // Melhor vizinho ainda livre que cabe no meshlet
+      glm::vec3 direction = glm::length(axis) > 0.0f ? glm::normalize(axis) : glm::vec3(0.0f);
+      float     best      = -std::numeric_limits<float>::max();
+      next                = -1;
+
+      for (uint32_t v : meshlet_vertices) {
+        for (uint32_t a = adjacency_offsets[v]; a < adjacency_offsets[v + 1]; a++) {
+          uint32_t candidate = adjacency[a];
+          if (emitted[candidate])
+            continue;
+
+          size_t new_vertices = 0;
+          for (int k = 0; k < 3; k++) {
+            uint32_t w        = indices[3 * candidate + k];
+            bool     repeated = (k > 0 && w == indices[3 * candidate]) || (k > 1 && w == indices[3 * candidate + 1]);
+            if (stamp[w] != current && !repeated)
+              new_vertices++;
+          }
+          if (meshlet_vertices.size() + new_vertices > kMeshletMaxVertices)
+            continue;
+
+          float score = glm::dot(normals[candidate], direction) - static_cast<float>(new_vertices);
+          if (score > best) {
+            best = score;
+            next = candidate;
+          }
+        }
+      }
+    }
+
+    meshlet.index_count = 3 * triangles;
+    out.push_back(meshlet);
+  }
+
+  std::copy(output.begin(), output.end(), indices);
+
+  // A ordem dentro de cada meshlet ainda pode ser otimizada para a cache
+  for (size_t m = first_meshlet; m < out.size(); m++) {
+    OptimizeVertexCache(mesh.indices.data() + out[m].first_index, out[m].index_count, num_vertices);
+    ComputeMeshletBounds(mesh, out[m]);
+  }
+}
+
+// Testa os meshlets [begin, end) de um objeto. Um meshlet é descartado se
+// sua esfera está fora de algum dos planos do frustum (em coordenadas
+// globais) ou se todos os seus triângulos estão de costas para a câmera. O
+// teste do cone é feito em coordenadas do modelo, onde vale para qualquer
+// matriz de modelagem afim. Os índices dos meshlets visíveis são
+// acrescentados a "visible".
+void CullMeshlets(const std::vector<Meshlet>& meshlets, size_t begin, size_t end, const MeshletCullInfo& info,
+                  std::vector<uint32_t>& visible) {
+  const glm::mat4&        M            = info.model;
+  const collision::Plane* planes       = info.planes;
+  const glm::vec3         camera_model = glm::vec3(glm::inverse(M) * glm::vec4(info.camera_position, 1.0f));
+  const float             scale        = culling::maxScale(M);
+
+  for (size_t i = begin; i < end; i++) {
+    const Meshlet& meshlet = meshlets[i];
+
+    // Cone de normais: todos os triângulos de costas se a câmera está fora
+    // do cone "dual", com a esfera inteira dentro dele
+    glm::vec3 to_center = meshlet.center - camera_model;
+    if (glm::dot(to_center, meshlet.cone_axis) >= meshlet.cone_cutoff * glm::length(to_center) + meshlet.radius)
+      continue;
+
+    // Esfera contra o frustum
+    glm::vec3 center = glm::vec3(M * glm::vec4(meshlet.center, 1.0f));
+    float     radius = meshlet.radius * scale;
+    bool      inside = true;
+    for (int p = 0; p < 6 && inside; p++)
+      inside = glm::dot(planes[p].normal, center) - planes[p].distance >= -radius;
+
+    if (inside)
+      visible.push_back(static_cast<uint32_t>(i));
+  }
+}
+
+#endif // MESHLET_HPP
@@ -0,0 +1,253 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// Eventos guardados no buffer circular (os mais antigos são sobrescritos)
+const size_t kProfilerRingSize = 16384;
+
+// Trechos abertos ao mesmo tempo, no máximo
+const int kProfilerMaxDepth = 16;
+
+// Consultas de tempo na GPU em voo, no máximo. Com poucos trechos por quadro
+// e o resultado chegando alguns quadros depois, 64 sobram.
+const uint32_t kProfilerMaxGpuQueries = 64;
+const uint32_t kProfilerNoQuery       = UINT32_MAX;
+
+// Peso de cada quadro nas médias por nome
+const double kProfilerSmoothing = 0.05;
+
+// Um trecho medido: na CPU (tid 1 no trace) ou na GPU (tid 2)
+struct ProfileEvent {
+  const char* name;    // Literal, nunca copiado
+  uint32_t    frame;
+  uint32_t    thread;  // 1 = CPU, 2 = GPU
+  double      startUs; // Desde a criação do Profiler
+  double      durationUs;
+};
+
+// Medidor de tempo por trecho do quadro. begin()/end() (normalmente pelas
+// macros PROFILE_BEGIN/PROFILE_END/PROFILE_SCOPE) marcam os trechos, que
+// podem ser aninhados; cada um vira um evento no buffer circular, exportado
+// por writeChromeTrace() no formato "trace_event" (chrome://tracing ou
+// Perfetto), e entra nas médias por nome mostradas na tela.
+//
+// O tempo na GPU vem de consultas GL_TIME_ELAPSED, feitas por quem tem o
+// contexto OpenGL pelas funções passadas a setGpuTimer(). Elas não podem ser
+// aninhadas, então só os trechos de primeiro nível são medidos na GPU. Os
+// resultados são lidos sem esperar, no beginFrame() dos quadros seguintes;
+// como a consulta mede só a duração, o evento da GPU é posto no instante em
+// que a CPU abriu o trecho.
+//
+// Os nomes são comparados pelo endereço, então devem ser literais. Nada é
+// alocado depois que todos os nomes apareceram uma vez.
+class Profiler {
+  public:
+  typedef std::function<void(uint32_t)>            BeginQuery;
+  typedef std::function<void()>                    EndQuery;
+  typedef std::function<bool(uint32_t, uint64_t&)> ReadQuery;
+
+  // Média móvel de cada nome, em milissegundos
+  struct ZoneStats {
+    const char* name;
+    double      cpuMs;
+    double      gpuMs;
+  };
+
+  Profiler()
+      : origin(Clock::now()), ring(kProfilerRingSize) {
+    for (uint32_t i = 0; i < kProfilerMaxGpuQueries; i++)
+      freeQueries.push_back(kProfilerMaxGpuQueries - 1 - i);
+    pendingGpu.reserve(kProfilerMaxGpuQueries);
+  }
+
+  // "begin" inicia a consulta de índice q (de 0 a kProfilerMaxGpuQueries - 1),
+  // "end" termina a consulta ativa e "read" devolve false se o resultado de q
+  // ainda não chegou, ou true e a duração em nanossegundos
+  void setGpuTimer(BeginQuery begin, EndQuery end, ReadQuery read) {
+    beginQuery = begin;
+    endQuery   = end;
+    readQuery  = read;
+  }
+
+  // Começo de um quadro: lê as consultas da GPU que ficaram prontas
+  void beginFrame() {
+    frame++;
+    for (size_t i = 0; i < pendingGpu.size();) {
+      uint64_t ns;
+      if (!readQuery(pendingGpu[i].query, ns)) {
+        i++;
+        continue;
+      }
+      const PendingQuery& done = pendingGpu[i];
+      ZoneStats&          z    = zone(done.name);
+      record(done.name, done.frame, 2, done.startUs, ns / 1000.0);
+      z.gpuMs += kProfilerSmoothing * (ns / 1.0e6 - z.gpuMs);
+      freeQueries.push_back(done.query);
+      pendingGpu[i] = pendingGpu.back();
+      pendingGpu.pop_back();
+    }
+  }
+
+  void begin(const char* name) {
+    if (depth == kProfilerMaxDepth) {
+      depth++; // end() correspondente só desfaz a contagem
+      return;
+    }
+
+    Open& open   = stack[depth];
+    open.name    = name;
+    open.startUs = now();
+    open.query   = kProfilerNoQuery;
+    if (depth == 0 && beginQuery && !freeQueries.empty()) {
+      open.query = freeQueries.back();
+      freeQueries.pop_back();
+      beginQuery(open.query);
+    }
+    depth++;
+  }
+
+  void end() {
+    depth--;
+    if (depth >= kProfilerMaxDepth)
+      return;
+
+    const Open& open       = stack[depth];
+    double      durationUs = now() - open.startUs;
+    ZoneStats&  z          = zone(open.name);
+    record(open.name, frame, 1, open.startUs, durationUs);
+    z.cpuMs += kProfilerSmoothing * (durationUs / 1000.0 - z.cpuMs);
+
+    if (open.query != kProfilerNoQuery) {
+      endQuery();
+      PendingQuery pending = {open.name, frame, open.startUs, open.query};
+      pendingGpu.push_back(pending);
+    }
+  }
+
+  const std::vector<ZoneStats>& getZones() const {
+    return zones;
+  }
+
+  // Grava os eventos do buffer, do mais antigo para o mais novo, como JSON
+  // "trace_event". Devolve false (e explica em stderr) se não conseguiu.
+  bool writeChromeTrace(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+      fprintf(stderr, "Não foi possível criar \"%s\".\n", path);
+      return false;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+    size_t count = (recorded < ring.size()) ? recorded : ring.size();
+    for (size_t k = 0; k < count; k++) {
+      const ProfileEvent& e = ring[(recorded - count + k) % ring.size()];
+      fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+              e.name, e.thread, e.startUs, e.durationUs, e.frame);
+    }
+    fprintf(file, "\n]}\n");
+
+    if (fclose(file) != 0) {
+      fprintf(stderr, "Erro ao gravar \"%s\".\n", path);
+      return false;
+    }
+    return true;
+  }
+
+  private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Open {
+    const char* name;
+    double      startUs;
+    uint32_t    query;
+  };
+
+  struct PendingQuery {
+    const char* name;
+    uint32_t    frame;
+    double      startUs;
+    uint32_t    query;
+  };
+
+  double now() const {
+    return std::chrono::duration<double, std::micro>(Clock::now() - origin).count();
+  }
+
+  void record(const char* name, uint32_t eventFrame, uint32_t thread, double startUs, double durationUs) {
+    ProfileEvent& e = ring[recorded % ring.size()];
+    e.name          = name;
+    e.frame         = eventFrame;
+    e.thread        = thread;
+    e.startUs       = startUs;
+    e.durationUs    = durationUs;
+    recorded++;
+  }
+
+  ZoneStats& zone(const char* name) {
+    for (ZoneStats& z : zones)
+      if (z.name == name)
+        return z;
+    ZoneStats z = {name, 0.0, 0.0};
+    zones.push_back(z);
+    return zones.back();
+  }
+
+  Clock::time_point         origin;
+  std::vector<ProfileEvent> ring;
+  size_t                    recorded = 0;
+  uint32_t                  frame    = 0;
+
+  Open stack[kProfilerMaxDepth];
+  int  depth = 0;
+
+  std::vector<ZoneStats>    zones;
+  std::vector<uint32_t>     freeQueries;
+  std::vector<PendingQuery> pendingGpu;
+  BeginQuery                beginQuery;
+  EndQuery                  endQuery;
+  ReadQuery                 readQuery;
+};
+
+// Marcadores. Com PROFILER_DISABLED definida na compilação eles somem e não
+// custam nada.
+#ifndef PROFILER_DISABLED
+
+// Mede o resto do bloco atual
+class ProfileScope {
+  public:
+  ProfileScope(Profiler& profiler, const char* name)
+      : profiler(profiler) {
+    profiler.begin(name);
+  }
+
+  ~ProfileScope() {
+    profiler.end();
+  }
+
+  private:
+  Profiler& profiler;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b)  PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(profiler, name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(profiler, name)
+#define PROFILE_BEGIN(profiler, name) (profiler).begin(name)
+#define PROFILE_END(profiler)         (profiler).end()
+
+#else
+
+#define PROFILE_SCOPE(profiler, name)
+#define PROFILE_BEGIN(profiler, name)
+#define PROFILE_END(profiler)
+
+#endif // PROFILER_DISABLED
+
+#endif // PROFILER_HPP
@@ -0,0 +1,289 @@
+#ifndef PVS_HPP
+#define PVS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <vector>
+#include "maze.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Índice do bit 1 menos significativo (bits != 0)
+inline int PVSLowestBit(uint64_t bits) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, bits);
+  return static_cast<int>(index);
+#elif defined(__GNUC__)
+  return __builtin_ctzll(bits);
+#else
+  int index = 0;
+  while ((bits & 1) == 0) {
+    bits >>= 1;
+    index++;
+  }
+  return index;
+#endif
+}
+
+// Quantidade de bits 1
+inline int PVSBitCount(uint64_t bits) {
+#if defined(_MSC_VER)
+  return static_cast<int>(__popcnt64(bits));
+#elif defined(__GNUC__)
+  return __builtin_popcountll(bits);
+#else
+  int count = 0;
+  for (; bits != 0; bits &= bits - 1)
+    count++;
+  return count;
+#endif
+}
+
+// Conjunto potencialmente visível (PVS) célula-a-célula do labirinto. Para
+// cada célula guardamos o conjunto de células que podem ser vistas de algum
+// ponto dentro dela, considerando um observador abaixo do topo das paredes.
+//
+// O cálculo é feito uma única vez, após a geração do labirinto, lançando
+// raios em 2D a partir de vários pontos de cada célula e percorrendo a grade
+// até encontrar uma parede. Como a amostragem pode perder frestas muito
+// estreitas, o resultado é dilatado em uma célula através das passagens
+// abertas e tornado simétrico, o que o torna conservador na prática.
+//
+// Cada conjunto é um bitset de width*height bits, comprimido guardando apenas
+// as palavras de 64 bits não nulas (índice da palavra + bits).
+class MazePVS {
+  private:
+  int width  = 0;
+  int height = 0;
+
+  vector<uint32_t> cellOffsets; // Palavras da célula i: [cellOffsets[i], cellOffsets[i + 1])
+  vector<uint32_t> wordIndices; // Índice de cada palavra no bitset denso
+  vector<uint64_t> wordBits;    // Conteúdo de cada palavra
+
+  // Percorre a grade a partir de (u, v), em unidades de célula, na direção
+  // (du, dv), marcando as células atravessadas até encontrar uma parede ou
+  // sair do labirinto (algoritmo de Amanatides e Woo).
+  void castRay(const MazeGenerator& maze, float u, float v, float du, float dv, vector<uint64_t>& dense) const {
+    const float infinity = numeric_limits<float>::infinity();
+
+    int cx = static_cast<int>(floor(u));
+    int cy = static_cast<int>(floor(v));
+
+    int   stepX   = du > 0.0f ? 1 : -1;
+    int   stepY   = dv > 0.0f ? 1 : -1;
+    float tDeltaX = du != 0.0f ? 1.0f / fabs(du) : infinity;
+    float tDeltaY = dv != 0.0f ? 1.0f / fabs(dv) : infinity;
+    float tMaxX   = du != 0.0f ? (du > 0.0f ? cx + 1 - u : u - cx) * tDeltaX : infinity;
+    float tMaxY   = dv != 0.0f ? (dv > 0.0f ? cy + 1 - v : v - cy) * tDeltaY : infinity;
+
+    // Direções: Norte, Sul, Leste, Oeste (mesma convenção de MazeGenerator)
+    const int dirX = stepX > 0 ? 2 : 3;
+    const int dirY = stepY > 0 ? 1 : 0;
+
+    while (true) {
+      int cell = cy * width + cx;
+      dense[cell >> 6] |= uint64_t(1) << (cell & 63);
+
+      if (tMaxX < tMaxY) {
+        if (maze.hasWall(cx, cy, dirX))
+          return;
+        cx += stepX;
+        tMaxX += tDeltaX;
+      } else {
+        if (maze.hasWall(cx, cy, dirY))
+          return;
+        cy += stepY;
+        tMaxY += tDeltaY;
+      }
+
+      if (cx < 0 || cx >= width || cy < 0 || cy >= height)
+        return;
+    }
+  }
+
+  public:
+  void build(const MazeGenerator& maze, int samplesPerAxis = 4, int raysPerSample = 256) {
+    width  = maze.getWidth();
+    height = maze.getHeight();
+
+    const int numCells = width * height;
+    const int numWords = (numCells + 63) / 64;
+
+    cellOffsets.assign(1, 0);
+    wordIndices.clear();
+    wordBits.clear();
+
+    vector<uint64_t>    dense(numWords);
+    vector<vector<int>> visibleCells(numCells);
+
+    // Direções dos raios, iguais para todos os pontos de amostragem
+    vector<float> rayU(raysPerSample), rayV(raysPerSample);
+    for (int r = 0; r < raysPerSample; r++) {
+      float angle = 2.0f * 3.14159265f * (r + 0.5f) / raysPerSample;
+      rayU[r]     = cos(angle);
+      rayV[r]     = sin(angle);
+    }
+
+    const int dx[4] = {0, 0, 1, -1};
+    const int dy[4] = {-1, 1, 0, 0};
+
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        fill(dense.begin(), dense.end(), 0);
+
+        // Pontos de amostragem espalhados pela célula, incluindo perto das
+        // bordas, já que a câmera pode encostar nas paredes.
+        for (int sy = 0; sy < samplesPerAxis; sy++) {
+          for (int sx = 0; sx < samplesPerAxis; sx++) {
+            float u = x + 0.05f + 0.9f * sx / (samplesPerAxis - 1);
+            float v = y + 0.05f + 0.9f * sy / (samplesPerAxis - 1);
+            for (int r = 0; r < raysPerSample; r++)
+              castRay(maze, u, v, rayU[r], rayV[r], dense);
+          }
+        }
+
+        // Dilatação: acrescenta os vizinhos acessíveis de cada célula visível
+        vector<int>& cells = visibleCells[y * width + x];
+        for (int w = 0; w < numWords; w++) {
+          uint64_t bits = dense[w];
+          while (bits != 0) {
+            int cell = w * 64 + PVSLowestBit(bits);
+            bits &= bits - 1;
+            cells.push_back(cell);
+
+            int cx = cell % width;
+            int cy = cell / width;
+            for (int dir = 0; dir < 4; dir++) {
+              int nx = cx + dx[dir];
+              int ny = cy + dy[dir];
+              if (nx < 0 || nx >= width || ny < 0 || ny >= height || maze.hasWall(cx, cy, dir))
+                continue;
+              cells.push_back(ny * width + nx);
+            }
+          }
+        }
+      }
+    }
+
+    // A visibilidade é simétrica: se A vê B, B também vê A. Unir cada conjunto
+    // com o seu transposto corrige raios perdidos pela amostragem.
+    for (int cell = 0; cell < numCells; cell++) {
+      size_t count = visibleCells[cell].size();
+      for (size_t i = 0; i < count; i++) {
+        int other = visibleCells[cell][i];
+        if (other != cell)
+          visibleCells[other].push_back(cell);
+      }
+    }
+
+    // Compressão: guardamos apenas as palavras de 64 bits não nulas
+    for (int cell = 0; cell < numCells; cell++) {
+      vector<int>& cells = visibleCells[cell];
+      sort(cells.begin(), cells.end());
+      cells.erase(unique(cells.begin(), cells.end()), cells.end());
+
+      for (size_t i = 0; i < cells.size(); i++) {
+        uint32_t word = static_cast<uint32_t>(cells[i] >> 6);
+        if (wordIndices.size() == cellOffsets.back() || wordIndices.back() != word) {
+          wordIndices.push_back(word);
+          wordBits.push_back(0);
+        }
+        wordBits.back() |= uint64_t(1) << (cells[i] & 63);
+      }
+      cellOffsets.push_back(static_cast<uint32_t>(wordBits.size()));
+
+      vector<int>().swap(cells);
+    }
+  }
+
+  // Indica se a célula "to" pertence ao PVS da célula "from"
+  bool isVisible(int from, int to) const {
+    uint32_t word = static_cast<uint32_t>(to >> 6);
+    uint32_t lo   = cellOffsets[from];
+    uint32_t hi   = cellOffsets[from + 1];
+
+    // Busca binária, já que as palavras de cada célula estão ordenadas
+    while (lo < hi) {
+      uint32_t mid = (lo + hi) / 2;
+      if (wordIndices[mid] < word)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    if (lo == cellOffsets[from + 1] || wordIndices[lo] != word)
+      return false;
+
+    return (wordBits[lo] >> (to & 63)) & 1;
+  }
+
+  // Descomprime o PVS da célula "cell" em uma lista de índices de células
+  void getVisibleCells(int cell, vector<int>& out) const {
+    out.clear();
+    for (uint32_t i = cellOffsets[cell]; i < cellOffsets[cell + 1]; i++) {
+      uint64_t bits = wordBits[i];
+      while (bits != 0) {
+        int bit = PVSLowestBit(bits);
+        out.push_back(static_cast<int>(wordIndices[i]) * 64 + bit);
+        bits &= bits - 1;
+      }
+    }
+  }
+
+  // Células visíveis de "a" ou de "b", sem repetições e em ordem crescente.
+  // As palavras das duas células já estão ordenadas, então basta intercalá-las.
+  void getVisibleCells(int a, int b, vector<int>& out) const {
+    out.clear();
+    uint32_t i = cellOffsets[a], iEnd = cellOffsets[a + 1];
+    uint32_t j = cellOffsets[b], jEnd = cellOffsets[b + 1];
+    while (i < iEnd || j < jEnd) {
+      uint32_t word;
+      uint64_t bits = 0;
+      if (j == jEnd || (i < iEnd && wordIndices[i] <= wordIndices[j]))
+        word = wordIndices[i];
+      else
+        word = wordIndices[j];
+      if (i < iEnd && wordIndices[i] == word)
+        bits |= wordBits[i++];
+      if (j < jEnd && wordIndices[j] == word)
+        bits |= wordBits[j++];
+
+      while (bits != 0) {
+        int bit = PVSLowestBit(bits);
+        out.push_back(static_cast<int>(word) * 64 + bit);
+        bits &= bits - 1;
+      }
+    }
+  }
+
+  size_t getCompressedBytes() const {
+    return cellOffsets.size() * sizeof(uint32_t) +
+           wordIndices.size() * sizeof(uint32_t) +
+           wordBits.size() * sizeof(uint64_t);
+  }
+
+  size_t getDenseBytes() const {
+    return static_cast<size_t>(width) * height * ((width * height + 63) / 64) * sizeof(uint64_t);
+  }
+
+  void printInfo() const {
+    size_t numCells     = static_cast<size_t>(width) * height;
+    size_t visibleTotal = 0;
+    for (size_t i = 0; i < wordBits.size(); i++)
+      visibleTotal += PVSBitCount(wordBits[i]);
+
+    printf("PVS: %.1f células visíveis por célula (de %d), %zu bytes comprimidos (denso: %zu bytes)\n",
+           numCells ? (double) visibleTotal / numCells : 0.0,
+           (int) numCells,
+           getCompressedBytes(),
+           getDenseBytes());
+  }
+};
+
+#endif // PVS_HPP
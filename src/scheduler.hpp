@@ -0,0 +1,229 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Tarefa adiável. Devolve true se ainda tem trabalho, e então é chamada de
+// novo (no mesmo quadro, se couber no orçamento, ou nos próximos), ou false
+// quando terminou. Assim um trabalho longo pode ser dividido em fatias.
+using FrameTask = std::function<bool()>;
+
+// Espera, em quadros, a partir da qual uma tarefa pendente conta como faminta
+const uint32_t kSchedulerStarvationFrames = 30;
+
+// A cada kSchedulerAgingFrames quadros de espera a prioridade efetiva de uma
+// tarefa sobe 1, para que um fluxo de tarefas mais prioritárias não adie as
+// outras para sempre
+const uint32_t kSchedulerAgingFrames = 8;
+
+// Escalonador de trabalho caro espalhado ao longo dos quadros. O trabalho é
+// dividido em categorias, cada uma com um orçamento em milissegundos por
+// quadro e uma fila com prioridades; run(), chamada uma vez por quadro,
+// executa as tarefas de cada categoria, da maior prioridade efetiva para a
+// menor, enquanto couberem no orçamento. Há também um orçamento total, que
+// limita a soma das categorias.
+//
+// Uma tarefa só começa se o custo estimado (média móvel das chamadas
+// anteriores com a mesma chave, ou das sem chave da categoria) cabe no que
+// resta do orçamento. A única exceção é uma tarefa faminta (pendente há
+// kSchedulerStarvationFrames quadros ou mais) quando nada rodou ainda na
+// categoria no quadro: sem isso uma tarefa maior que o orçamento nunca
+// rodaria. O estouro fica então limitado a uma chamada por categoria a cada
+// kSchedulerStarvationFrames quadros, e é contado nas estatísticas.
+//
+// Tarefas com chave diferente de 0 substituem a pendente com a mesma chave na
+// categoria, o que serve para recálculos em que só o pedido mais recente
+// importa (a nova tarefa herda a espera da antiga).
+class FrameScheduler {
+  public:
+  struct Stats {
+    size_t   executed  = 0;   // Chamadas no último run()
+    size_t   completed = 0;   // Tarefas terminadas no último run()
+    size_t   deferred  = 0;   // Pendentes ao fim do último run()
+    size_t   starved   = 0;   // Pendentes há kSchedulerStarvationFrames quadros ou mais
+    uint32_t maxWait   = 0;   // Maior espera entre as pendentes, em quadros
+    double   usedMs    = 0.0; // Tempo gasto no último run()
+    double   costMs    = 0.0; // Custo estimado de uma chamada sem chave
+    size_t   overruns  = 0;   // Quadros em que o orçamento estourou, desde o início
+  };
+
+  explicit FrameScheduler(double totalBudgetMs)
+      : totalBudgetMs(totalBudgetMs) {
+  }
+
+  // Cria uma categoria e devolve o seu índice. As categorias rodam na ordem
+  // em que foram criadas, então as mais importantes devem vir primeiro.
+  int addCategory(const char* name, double budgetMs) {
+    categories.push_back(Category());
+    categories.back().name     = name;
+    categories.back().budgetMs = budgetMs;
+    return static_cast<int>(categories.size()) - 1;
+  }
+
+  void setBudget(int category, double budgetMs) {
+    categories[category].budgetMs = budgetMs;
+  }
+
+  void submit(int category, int priority, FrameTask task, uint64_t key = 0) {
+    std::vector<Task>& queue = categories[category].queue;
+    if (key != 0) {
+      for (Task& pending : queue) {
+        if (pending.key == key) {
+          pending.run      = std::move(task);
+          pending.priority = priority;
+          return;
+        }
+      }
+    }
+
+    Task entry;
+    entry.run          = std::move(task);
+    entry.priority     = priority;
+    entry.key          = key;
+    entry.waitingSince = frameIndex;
+    queue.push_back(std::move(entry));
+  }
+
+  // Executa as tarefas do quadro
+  void run() {
+    typedef std::chrono::steady_clock Clock;
+
+    frameIndex++;
+    const Clock::time_point frameStart = Clock::now();
+
+    for (Category& c : categories) {
+      Stats& s    = c.stats;
+      s.executed  = 0;
+      s.completed = 0;
+      s.usedMs    = 0.0;
+
+      double remainingMs   = totalBudgetMs - std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+      double budgetMs      = std::min(c.budgetMs, remainingMs);
+      Clock::time_point t0 = Clock::now();
+
+      while (!c.queue.empty() && budgetMs > 0.0) {
+        size_t best     = pick(c.queue);
+        double estimate = costOf(c, c.queue[best].key);
+        bool   starved  = frameIndex - c.queue[best].waitingSince >= kSchedulerStarvationFrames;
+        if (s.usedMs + estimate > budgetMs && !(starved && s.executed == 0))
+          break;
+
+        // A tarefa sai da fila antes de rodar, porque ela pode submeter outras
+        Task task = std::move(c.queue[best]);
+        c.queue.erase(c.queue.begin() + best);
+
+        Clock::time_point callStart = Clock::now();
+        bool              more      = task.run();
+        Clock::time_point callEnd   = Clock::now();
+
+        double  callMs = std::chrono::duration<double, std::milli>(callEnd - callStart).count();
+        double& cost   = costOf(c, task.key);
+        cost           = (cost == 0.0) ? callMs : 0.8 * cost + 0.2 * callMs;
+        s.usedMs       = std::chrono::duration<double, std::milli>(callEnd - t0).count();
+        s.executed++;
+
+        if (more) {
+          task.waitingSince = frameIndex;
+          c.queue.push_back(std::move(task));
+        } else {
+          s.completed++;
+        }
+      }
+      if (s.usedMs > c.budgetMs)
+        s.overruns++;
+
+      s.deferred = c.queue.size();
+      s.starved  = 0;
+      s.maxWait  = 0;
+      for (const Task& task : c.queue) {
+        uint32_t wait = frameIndex - task.waitingSince;
+        s.maxWait     = std::max(s.maxWait, wait);
+        if (wait >= kSchedulerStarvationFrames)
+          s.starved++;
+      }
+    }
+  }
+
+  size_t getCategoryCount() const {
+    return categories.size();
+  }
+
+  const char* getName(int category) const {
+    return categories[category].name;
+  }
+
+  const Stats& getStats(int category) const {
+    return categories[category].stats;
+  }
+
+  // Tarefas pendentes e famintas somadas em todas as categorias
+  size_t getDeferredCount() const {
+    size_t count = 0;
+    for (const Category& c : categories)
+      count += c.stats.deferred;
+    return count;
+  }
+
+  size_t getStarvedCount() const {
+    size_t count = 0;
+    for (const Category& c : categories)
+      count += c.stats.starved;
+    return count;
+  }
+
+  private:
+  struct Task {
+    FrameTask run;
+    int       priority;
+    uint64_t  key;
+    uint32_t  waitingSince; // Quadro da submissão ou da última chamada
+  };
+
+  struct Category {
+    const char*       name;
+    double            budgetMs;
+    std::vector<Task> queue;
+    Stats             stats;
+
+    std::vector<std::pair<uint64_t, double>> keyCosts; // Custo estimado por chave
+  };
+
+  // Custo estimado de uma chamada de tarefa com a chave "key" (0 = sem chave)
+  static double& costOf(Category& c, uint64_t key) {
+    if (key == 0)
+      return c.stats.costMs;
+    for (std::pair<uint64_t, double>& entry : c.keyCosts)
+      if (entry.first == key)
+        return entry.second;
+    c.keyCosts.push_back(std::make_pair(key, 0.0));
+    return c.keyCosts.back().second;
+  }
+
+  // Maior prioridade efetiva; no empate, a que espera há mais tempo. As filas
+  // são curtas (dezenas de tarefas), então a busca linear basta.
+  size_t pick(const std::vector<Task>& queue) const {
+    size_t  best         = 0;
+    int64_t bestPriority = 0;
+    for (size_t i = 0; i < queue.size(); i++) {
+      uint32_t wait     = frameIndex - queue[i].waitingSince;
+      int64_t  priority = static_cast<int64_t>(queue[i].priority) + wait / kSchedulerAgingFrames;
+      if (i == 0 || priority > bestPriority ||
+          (priority == bestPriority && queue[i].waitingSince < queue[best].waitingSince)) {
+        best         = i;
+        bestPriority = priority;
+      }
+    }
+    return best;
+  }
+
+  double                totalBudgetMs;
+  uint32_t              frameIndex = 0;
+  std::vector<Category> categories;
+};
+
+#endif // SCHEDULER_HPP
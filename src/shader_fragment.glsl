@@ -21,6 +21,9 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// Posição da câmera em coordenadas globais, enviada pelo código C++
+uniform vec4 camera_position;
+
 // Material uniforms
 uniform vec3 kd;
 uniform vec3 ka;
@@ -63,11 +66,6 @@ out vec4 color;
 
 void main()
 {
-    // Obtemos a posição da câmera utilizando a inversa da matriz que define o
-    // sistema de coordenadas da câmera.
-    vec4 origin = vec4(0.0, 0.0, 0.0, 1.0);
-    vec4 camera_position = inverse(view) * origin;
-
     // O fragmento atual é coberto por um ponto que percente à superfície de um
     // dos objetos virtuais da cena. Este ponto, p, possui uma posição no
     // sistema de coordenadas global (World coordinates). Esta posição é obtida
@@ -11,6 +11,26 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// Produto projection*view, mantido em cache pela câmera e enviado uma vez por
+// quadro. Evita uma multiplicação de matrizes por vértice.
+uniform mat4 view_projection;
+
+// Vértices comprimidos (veja QuantizedVertex em "mesh.hpp"). Neste caso
+// model_coefficients.xyz chega em [0,1] e é relativo à bounding box do
+// objeto, normal_coefficients.xy é a normal em codificação octaédrica e
+// texture_coefficients vem de meia precisão (já convertida pela GPU).
+uniform bool quantized;
+uniform vec4 bbox_min;
+uniform vec4 bbox_max;
+
+vec3 decode_octahedral(vec2 e)
+{
+    vec3 n = vec3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
 // Atributos de vértice que serão gerados como saída ("out") pelo Vertex Shader.
 // ** Estes serão interpolados pelo rasterizador! ** gerando, assim, valores
 // para cada fragmento, os quais serão recebidos como entrada pelo Fragment
@@ -22,6 +42,14 @@ out vec2 texcoords;
 
 void main()
 {
+    vec4 position_coefficients = model_coefficients;
+    vec4 normal_model = normal_coefficients;
+    if (quantized)
+    {
+        position_coefficients = vec4(mix(bbox_min.xyz, bbox_max.xyz, model_coefficients.xyz), 1.0);
+        normal_model = vec4(decode_octahedral(normal_coefficients.xy), 0.0);
+    }
+
     // A variável gl_Position define a posição final de cada vértice
     // OBRIGATORIAMENTE em "normalized device coordinates" (NDC), onde cada
     // coeficiente estará entre -1 e 1 após divisão por w.
@@ -34,7 +62,7 @@ void main()
     // deste Vertex Shader, a placa de vídeo (GPU) fará a divisão por W. Veja
     // slides 41-67 e 69-86 do documento Aula_09_Projecoes.pdf.
 
-    gl_Position = projection * view * model * model_coefficients;
+    gl_Position = view_projection * model * position_coefficients;
 
     // Como as variáveis acima  (tipo vec4) são vetores com 4 coeficientes,
     // também é possível acessar e modificar cada coeficiente de maneira
@@ -51,14 +79,14 @@ void main()
     // rasterizador para gerar atributos únicos para cada fragmento gerado.
 
     // Posição do vértice atual no sistema de coordenadas global (World).
-    position_world = model * model_coefficients;
+    position_world = model * position_coefficients;
 
     // Posição do vértice atual no sistema de coordenadas local do modelo.
-    position_model = model_coefficients;
+    position_model = position_coefficients;
 
     // Normal do vértice atual no sistema de coordenadas global (World).
     // Veja slides 123-151 do documento Aula_07_Transformacoes_Geometricas_3D.pdf.
-    normal = inverse(transpose(model)) * normal_coefficients;
+    normal = inverse(transpose(model)) * normal_model;
     normal.w = 0.0;
 
     // Coordenadas de textura obtidas do arquivo OBJ (se existirem!)
@@ -0,0 +1,142 @@
+#ifndef SPATIALHASH_HPP
+#define SPATIALHASH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Fim de lista em SpatialHash
+const uint32_t kSpatialHashNone = UINT32_MAX;
+
+// Hash espacial uniforme sobre o plano XZ. A célula de um ponto é
+// (floor(x / cellSize + 0.5), floor(z / cellSize + 0.5)), a mesma convenção
+// de MazeGenerator::worldToCell(), então com cellSize = 2 as chaves são as
+// células do labirinto (e continuam valendo fora dele).
+//
+// Cada entrada fica em uma lista duplamente ligada do seu balde, guardada em
+// vetores (sem alocação por entrada), de forma que move() troca uma entrada
+// de célula em O(1). Quem chama decide a chave: um ponto pode estar até
+// "slack" fora da sua célula (por exemplo, um inimigo a caminho da célula
+// vizinha continua na célula de origem), e as consultas alargam a busca
+// nessa medida. As posições não ficam no hash: as consultas recebem os
+// vetores de coordenadas e fazem o teste exato de distância.
+class SpatialHash {
+  public:
+  explicit SpatialHash(float cellSize = 2.0f, float slack = 0.0f)
+      : cellSize(cellSize), slack(slack) {
+  }
+
+  int cellOf(float v) const {
+    return static_cast<int>(floor(v / cellSize + 0.5f));
+  }
+
+  // Refaz a tabela com n entradas, a entrada i na célula (cellX[i], cellZ[i])
+  void build(const int32_t* cellX, const int32_t* cellZ, size_t n) {
+    size_t tableSize = 16;
+    while (tableSize < n)
+      tableSize *= 2;
+    mask = tableSize - 1;
+
+    head.assign(tableSize, kSpatialHashNone);
+    next.resize(n);
+    prev.resize(n);
+    keyX.resize(n);
+    keyZ.resize(n);
+    for (size_t i = 0; i < n; i++)
+      link(static_cast<uint32_t>(i), cellX[i], cellZ[i]);
+  }
+
+  size_t size() const {
+    return keyX.size();
+  }
+
+  // Passa a entrada i para a célula (cellX, cellZ)
+  void move(uint32_t i, int cellX, int cellZ) {
+    if (keyX[i] == cellX && keyZ[i] == cellZ)
+      return;
+    unlink(i);
+    link(i, cellX, cellZ);
+  }
+
+  // Chama f(índice, distância ao quadrado) para cada entrada a até "radius"
+  // de (x, z), com as posições em (xs[i], zs[i])
+  template <typename F>
+  void forEachInRadius(float x, float z, float radius, const float* xs, const float* zs, F f) const {
+    if (head.empty())
+      return;
+
+    const float radiusSq = radius * radius;
+    const int   cx0      = cellOf(x - radius - slack);
+    const int   cx1      = cellOf(x + radius + slack);
+    const int   cz0      = cellOf(z - radius - slack);
+    const int   cz1      = cellOf(z + radius + slack);
+
+    for (int cz = cz0; cz <= cz1; cz++) {
+      for (int cx = cx0; cx <= cx1; cx++) {
+        for (uint32_t i = head[bucketOf(cx, cz)]; i != kSpatialHashNone; i = next[i]) {
+          if (keyX[i] != cx || keyZ[i] != cz)
+            continue; // Outra célula no mesmo balde
+          float dx = xs[i] - x;
+          float dz = zs[i] - z;
+          float d2 = dx * dx + dz * dz;
+          if (d2 <= radiusSq)
+            f(i, d2);
+        }
+      }
+    }
+  }
+
+  // Índice da entrada mais próxima de (x, z) a até maxRadius, diferente de
+  // "exclude", ou -1. O raio de busca começa em uma célula e dobra até achar
+  // alguém: o mais próximo dentro de um raio é o mais próximo de todos.
+  int nearest(float x, float z, float maxRadius, const float* xs, const float* zs, int exclude = -1) const {
+    int   best   = -1;
+    float bestSq = 0.0f;
+    for (float radius = std::min(cellSize, maxRadius);; radius = std::min(2.0f * radius, maxRadius)) {
+      forEachInRadius(x, z, radius, xs, zs, [&](uint32_t i, float d2) {
+        if (static_cast<int>(i) != exclude && (best < 0 || d2 < bestSq)) {
+          best   = static_cast<int>(i);
+          bestSq = d2;
+        }
+      });
+      if (best >= 0 || radius >= maxRadius)
+        return best;
+    }
+  }
+
+  private:
+  uint32_t bucketOf(int cx, int cz) const {
+    return (static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cz) * 19349663u) & mask;
+  }
+
+  void link(uint32_t i, int cellX, int cellZ) {
+    uint32_t bucket = bucketOf(cellX, cellZ);
+    keyX[i]         = cellX;
+    keyZ[i]         = cellZ;
+    prev[i]         = kSpatialHashNone;
+    next[i]         = head[bucket];
+    if (head[bucket] != kSpatialHashNone)
+      prev[head[bucket]] = i;
+    head[bucket] = i;
+  }
+
+  void unlink(uint32_t i) {
+    if (prev[i] != kSpatialHashNone)
+      next[prev[i]] = next[i];
+    else
+      head[bucketOf(keyX[i], keyZ[i])] = next[i];
+    if (next[i] != kSpatialHashNone)
+      prev[next[i]] = prev[i];
+  }
+
+  float    cellSize;
+  float    slack;
+  uint32_t mask = 0;
+
+  std::vector<uint32_t> head; // Primeira entrada de cada balde
+  std::vector<uint32_t> next, prev;
+  std::vector<int32_t>  keyX, keyZ; // Célula de cada entrada
+};
+
+#endif // SPATIALHASH_HPP
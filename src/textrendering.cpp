@@ -10,6 +10,7 @@
 
 #include "utils.h"
 #include "dejavufont.h"
+#include "glinstrument.hpp"
 
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Função definida em main.cpp
 
@@ -144,7 +145,9 @@ void TextRendering_Init()
 
 float textscale = 1.5f;
 
-void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float x, float y, float scale = 1.0f)
+// Versão para texto em buffers de char, que não cria uma std::string (e não
+// aloca memória) a cada chamada
+void TextRendering_PrintString(GLFWwindow* window, const char* str, float x, float y, float scale = 1.0f)
 {
     scale *= textscale;
     int width, height;
@@ -152,7 +155,21 @@ void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float
     float sx = scale / width;
     float sy = scale / height;
 
-    for (size_t i = 0; i < str.size(); i++)
+    if (str[0] == '\0')
+        return;
+
+    // O estado é o mesmo para todos os caracteres, então é definido uma vez
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glDepthFunc(GL_ALWAYS);
+    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
+
+    glUseProgram(textprogram_id);
+    glBindVertexArray(textVAO);
+
+    for (size_t i = 0; str[i] != '\0'; i++)
     {
         // Find the glyph for the character we are looking for
         texture_glyph_t *glyph = 0;
@@ -187,28 +204,23 @@ void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float
             { x1, y0, s1, t0 }
         };
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glDepthFunc(GL_ALWAYS);
-        glBindBuffer(GL_ARRAY_BUFFER, textVBO);
         glBufferSubData(GL_ARRAY_BUFFER, 0, 24 * sizeof(float), data);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        glUseProgram(textprogram_id);
-        glBindVertexArray(textVAO);
-
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
-        glBindVertexArray(0);
-        glUseProgram(0);
-        glDepthFunc(GL_LESS);
-
-        glDisable(GL_BLEND);
-
         x += (glyph->advance_x * sx);
     }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glDepthFunc(GL_LESS);
+
+    glDisable(GL_BLEND);
+}
+
+void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float x, float y, float scale = 1.0f)
+{
+    TextRendering_PrintString(window, str.c_str(), x, y, scale);
 }
 
 float TextRendering_LineHeight(GLFWwindow* window)
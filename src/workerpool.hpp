@@ -0,0 +1,105 @@
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads criadas uma vez e acordadas a cada run(), para trabalho paralelo
+// de todo quadro sem o custo (e as alocações) de criar threads. A thread que
+// chama run() também trabalha, como a de índice 0, e só volta quando todas
+// terminaram.
+//
+// A função é passada por referência e chamada por um ponteiro sem tipo, então
+// run() não aloca nada. Só uma thread pode chamar run() por vez.
+class WorkerPool {
+  public:
+  // "numThreads" conta a thread que chama run()
+  explicit WorkerPool(unsigned int numThreads) {
+    for (unsigned int slot = 1; slot < numThreads; slot++)
+      threads.emplace_back(&WorkerPool::loop, this, slot);
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads)
+      t.join();
+  }
+
+  // Threads disponíveis, contando a que chama run()
+  unsigned int size() const {
+    return static_cast<unsigned int>(threads.size()) + 1;
+  }
+
+  // Chama f(slot) para slot de 0 a numWorkers - 1 (no máximo size()), cada
+  // um em uma thread, e espera todos terminarem
+  template <typename F>
+  void run(unsigned int numWorkers, F& f) {
+    numWorkers = (numWorkers < size()) ? numWorkers : size();
+    if (numWorkers <= 1) {
+      f(0);
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      call    = [](void* context, unsigned int slot) { (*static_cast<F*>(context))(slot); };
+      context = &f;
+      active  = numWorkers - 1;
+      pending = numWorkers - 1;
+      generation++;
+    }
+    wake.notify_all();
+
+    f(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+  }
+
+  private:
+  WorkerPool(const WorkerPool&);
+  WorkerPool& operator=(const WorkerPool&);
+
+  void loop(unsigned int slot) {
+    uint64_t                     seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      wake.wait(lock, [&] { return stopping || generation != seen; });
+      if (stopping)
+        return;
+      seen = generation;
+      if (slot > active)
+        continue; // Não participa desta rodada
+
+      void (*function)(void*, unsigned int) = call;
+      void* argument                        = context;
+      lock.unlock();
+      function(argument, slot);
+      lock.lock();
+      if (--pending == 0)
+        done.notify_one();
+    }
+  }
+
+  std::vector<std::thread> threads;
+  std::mutex               mutex;
+  std::condition_variable  wake;
+  std::condition_variable  done;
+
+  // Protegidos por "mutex"
+  void (*call)(void*, unsigned int) = NULL;
+  void*        context              = NULL;
+  unsigned int active               = 0; // Threads (além da que chama) nesta rodada
+  unsigned int pending              = 0; // Delas, as que ainda não terminaram
+  uint64_t     generation           = 0;
+  bool         stopping             = false;
+};
+
+#endif // WORKERPOOL_HPP